@@ -4,18 +4,117 @@
 #include <iostream>
 #include <Eigen/Core>
 #include "app/include/ldg/util/tree_functions.hpp"
+#include "app/include/program/input/input_configuration.hpp"
+#include "storage.hpp"
+#include "mapped_file.hpp"
 
 namespace adapter
 {
     /**
-     * Load data from a JSON config file into a vector compatible with the QuadAssignmentTree. Note that all extra cells are set to nullptrs.
+     * Copy a buffer of FileDataType values into the first rows of a feature matrix, converting to the scalar type of the matrix.
+     *
+     * @tparam FileDataType
+     * @tparam VectorType
+     * @param matrix
+     * @param data
+     * @param data_size Number of values in the buffer.
+     * @param num_elements  Number of rows to copy.
+     */
+    template<typename FileDataType, typename VectorType>
+    void copyBufferIntoMatrix(ldg::FeatureMatrix<VectorType> &matrix, const FileDataType *data, size_t data_size, size_t num_elements)
+    {
+        // The data array can be viewed as a data_num_elements x element_len matrix. We copy this row by row.
+        size_t element_len = matrix.getElementLen();
+        size_t num_rows = std::min(num_elements, data_size / element_len);
+#pragma omp parallel for schedule(static)
+        for (size_t row = 0; row < num_rows; ++row) {
+            matrix.setRow(row, Eigen::Map<const Eigen::Matrix<FileDataType, Eigen::Dynamic, 1>>(
+                data + ldg::rowMajorIndex(row, 0, element_len),
+                element_len
+            ).template cast<typename VectorType::Scalar>());
+        }
+    }
+
+    /**
+     * Read a file of FileDataType values into the first rows of a feature matrix, converting to the scalar type of the matrix.
+     * Raw files are mapped and copied directly, such that the data is only held in memory once.
+     *
+     * @tparam FileDataType
+     * @tparam VectorType
+     * @param matrix
+     * @param file_name
+     * @param num_elements  Number of rows to read.
+     * @param buffer_size   Expected number of values in the file.
+     * @return False if the file could not be read.
+     */
+    template<typename FileDataType, typename VectorType>
+    bool readFileIntoMatrix(ldg::FeatureMatrix<VectorType> &matrix, std::string const &file_name, size_t num_elements, size_t buffer_size)
+    {
+        if (file_name.ends_with(".raw")) {
+            MappedFile file(file_name);
+            if (!file.isMapped()) {
+                return false;
+            }
+            copyBufferIntoMatrix(matrix, static_cast<const FileDataType *>(file.data()), file.size() / sizeof(FileDataType), num_elements);
+            return true;
+        }
+
+        std::vector<FileDataType> data(buffer_size, 0);
+        if (readFileIntoBuffer(data, file_name) < 0) {
+            return false;
+        }
+        copyBufferIntoMatrix(matrix, data.data(), data.size(), num_elements);
+
+        return true;
+    }
+
+    /**
+     * Create a feature matrix where the data elements are read-only rows of a memory-mapped file, such that the data does
+     * not have to fit in memory. Compressed files are decompressed into a cache file that is mapped instead.
+     * Only the void cells and aggregates are stored in memory.
+     *
+     * @tparam VectorType
+     * @param file_name
+     * @param required_capacity
+     * @param element_len
+     * @param num_elements
+     * @return An empty matrix if the file could not be mapped.
+     */
+    template<typename VectorType>
+    ldg::FeatureMatrix<VectorType> mapDataFile(std::string const &file_name, size_t required_capacity, size_t element_len, size_t num_elements)
+    {
+        std::string mapped_file_name = file_name;
+        if (file_name.ends_with(".bz2")) {
+            mapped_file_name = getDecompressedCache(file_name);
+        } else if (!file_name.ends_with(".raw")) {
+            return {};
+        }
+        if (mapped_file_name.empty()) {
+            return {};
+        }
+
+        auto file = std::make_shared<MappedFile>(mapped_file_name);
+        if (!file->isMapped()) {
+            return {};
+        }
+        using Scalar = typename VectorType::Scalar;
+        size_t num_rows = std::min(num_elements, file->size() / (element_len * sizeof(Scalar)));
+        auto rows = static_cast<const Scalar *>(file->data());
+        return ldg::FeatureMatrix<VectorType>(required_capacity, element_len, std::move(file), rows, num_rows);
+    }
+
+    /**
+     * Load data from a JSON config file into a feature matrix compatible with the QuadAssignmentTree. Note that all extra cells are set to void.
+     * If memory mapping is requested and the data is stored in the type used in memory, the data elements are mapped instead of loaded.
      *
      * @tparam VectorType
      * @param config
+     * @param config_dir
+     * @param memory_map
      * @return
      */
     template<typename VectorType>
-    std::vector<std::shared_ptr<VectorType>> loadData(program::InputConfiguration &config, std::string config_dir)
+    ldg::FeatureMatrix<VectorType> loadData(program::InputConfiguration &config, std::string config_dir, bool memory_map = false)
     {
         // Check dims
         auto [num_rows, num_cols] = config.grid_dims;
@@ -26,31 +125,83 @@ namespace adapter
             exit(EXIT_FAILURE);
         }
 
-        // Load the data
-        std::vector<double> data(element_len * grid_num_elements, 0.);
-        if (!readFileIntoBuffer(data, config_dir + config.data_path)) {
-            std::cerr << "Error: Unable to load data from file \"" << config_dir + config.data_path << "\"\n";
-            exit(EXIT_FAILURE);
+        // Load the data in its file type and copy it over into the quad tree feature matrix
+        size_t required_capacity = ldg::determineRequiredArrayCapacity(num_rows, num_cols);
+        std::string file_name = config_dir + config.data_path;
+        ldg::FeatureMatrix<VectorType> quad_tree_data;
+        bool has_read = false;
+        if (memory_map) {
+            auto memory_data_type = program::mapScalarToDataType<typename VectorType::Scalar>();
+            if (config.data_type == memory_data_type) {
+                quad_tree_data = mapDataFile<VectorType>(file_name, required_capacity, element_len, config.num_elements);
+                has_read = quad_tree_data.size() > 0;
+            }
+            if (!has_read) {
+                std::cerr << "Warning: Unable to map " << program::mapDataTypeToString(config.data_type) << " data from file \"" << file_name
+                    << "\" as " << program::mapDataTypeToString(memory_data_type) << ", loading it into memory instead.\n";
+            }
         }
 
-        // Copy data over from data buffer into quad tree vector
-        size_t required_capacity = ldg::determineRequiredArrayCapacity(num_rows, num_cols);
-        std::vector<std::shared_ptr<VectorType>> quad_tree_data(required_capacity, nullptr);
-        // The data array can be viewed as a data_num_elements x element_len matrix. We copy this into vectors.
-        for (size_t row = 0; row < config.num_elements; ++row) {
-            VectorType vector(element_len);
-            for (size_t col = 0; col < element_len; ++col) {
-                vector(col) = data[ldg::rowMajorIndex(row, col, element_len)];
+        if (!has_read) {
+            quad_tree_data = ldg::FeatureMatrix<VectorType>(required_capacity, element_len);
+            size_t buffer_size = element_len * grid_num_elements;
+            switch (config.data_type) {
+                case program::DataType::FLOAT64:
+                    has_read = readFileIntoMatrix<double>(quad_tree_data, file_name, config.num_elements, buffer_size);
+                    break;
+                case program::DataType::FLOAT32:
+                    has_read = readFileIntoMatrix<float>(quad_tree_data, file_name, config.num_elements, buffer_size);
+                    break;
+                case program::DataType::UINT8:
+                    has_read = readFileIntoMatrix<uint8_t>(quad_tree_data, file_name, config.num_elements, buffer_size);
+                    break;
+                case program::DataType::UINT16:
+                    has_read = readFileIntoMatrix<uint16_t>(quad_tree_data, file_name, config.num_elements, buffer_size);
+                    break;
             }
-            quad_tree_data[row] = std::make_shared<VectorType>(vector);
+        }
+        if (!has_read) {
+            std::cerr << "Error: Unable to load data from file \"" << file_name << "\"\n";
+            exit(EXIT_FAILURE);
         }
         // Initialize all aggregates to 0.
-        for (auto iterator = quad_tree_data.begin() + grid_num_elements; iterator != quad_tree_data.end(); ++iterator) {
-            *iterator = std::make_shared<Eigen::VectorXd>(Eigen::VectorXd::Zero(element_len));
+        for (size_t row = grid_num_elements; row < required_capacity; ++row) {
+            quad_tree_data.setRow(row, VectorType::Zero(element_len));
         }
 
         return quad_tree_data;
     }
+
+    /**
+     * Scale the data elements to unit length, such that every element weighs equally in the averaged parents.
+     * Empty elements are kept as is. Only floating point data stored in memory can be normalized.
+     *
+     * @tparam VectorType
+     * @param matrix
+     * @param num_elements
+     * @return True if the data was normalized.
+     */
+    template<typename VectorType>
+    bool normalizeData(ldg::FeatureMatrix<VectorType> &matrix, size_t num_elements)
+    {
+        using Scalar = typename VectorType::Scalar;
+        if constexpr (!std::is_floating_point_v<Scalar>) {
+            return false;
+        } else {
+            if (matrix.getNumExternalRows() > 0)
+                return false;
+
+#pragma omp parallel for schedule(static)
+            for (size_t row = 0; row < num_elements; ++row) {
+                auto view = matrix.getRow(row);
+                if (view != nullptr && view.getNorm() > 0.) {
+                    matrix.getMutableRow(row) /= static_cast<Scalar>(view.getNorm());
+                    matrix.updateNorm(row);
+                }
+            }
+            return true;
+        }
+    }
 }
 
 #endif //LDG_CORE_DATA_HPP
\ No newline at end of file
@@ -3,7 +3,6 @@
 
 #include <vector>
 #include <cstddef>
-#include <cmath>
 #include "app/include/ldg/util/math.hpp"
 
 /*
@@ -21,6 +20,7 @@
  * [ 12 13 14 15 ]
  *
  * Where the way of converting between both layouts is determined by the row-major partition index over all heights.
+ * This makes the hierarchical layout the Z-order (Morton) layout, with the column in the lowest bit.
  */
 
 namespace adapter
@@ -28,7 +28,7 @@ namespace adapter
     /**
      * Copy data from a hierarchical vector to a row-major vector.
      * Note that this overrides the data in destination and assumes destination can hold the data.
-     *
+     * The hierarchical index is the Z-order index of a cell, so the cell is found by de-interleaving the index bits.
      *
      * @tparam SourceDataType
      * @tparam DestinationDataType
@@ -45,30 +45,9 @@ namespace adapter
         size_t num_cols
     )
     {
-        size_t depth = std::ceil(std::log2(std::max(num_rows, num_cols))) - 1;
-        size_t partition_length = std::pow(2, depth++);
-        std::vector<size_t> partition_lengths;
-        std::vector<size_t> partition_areas;
-        partition_lengths.reserve(depth);
-        partition_areas.reserve(depth);
-        for (size_t idx = 0; idx < depth; ++idx, partition_length /= 2) {
-            partition_lengths.push_back(partition_length);
-            partition_areas.push_back(partition_length * partition_length);
-        }
-
 #pragma omp parallel for schedule(static)
         for (size_t idx = 0; idx < source.size(); ++idx) {
-            size_t x = 0;
-            size_t y = 0;
-
-            size_t idx_copy = idx;
-            for (size_t size_idx = 0; size_idx < depth; ++size_idx) {
-                size_t partition_idx = idx_copy / partition_areas[size_idx];
-                x += (partition_idx % 2) * partition_lengths[size_idx];
-                y += (partition_idx / 2) * partition_lengths[size_idx];
-                idx_copy %= partition_areas[size_idx];
-            }
-
+            auto [y, x] = ldg::mortonPosition(idx);
             if (x < num_cols && y < num_rows) {
                 destination[ldg::rowMajorIndex(y, x, num_cols)] = source[idx];
             }
@@ -76,7 +55,7 @@ namespace adapter
     }
 
     /**
-     * Copy data from a hierarchical vector to a row-major vector.
+     * Copy data from a row-major vector to a hierarchical vector.
      * Note that this overrides the data in destination and assumes destination can hold the data.
      * We assume the destination to be initialized to void tiles to take the bounds into account.
      *
@@ -95,34 +74,10 @@ namespace adapter
         size_t num_cols
     )
     {
-        size_t depth = std::ceil(std::log2(std::max(num_rows, num_cols))) - 1;
-        size_t partition_length = std::pow(2, depth++);
-        std::vector<size_t> partition_lengths;
-        std::vector<size_t> partition_areas;
-        partition_lengths.reserve(depth);
-        partition_areas.reserve(depth);
-        for (size_t idx = 0; idx < depth; ++idx, partition_length /= 2) {
-            partition_lengths.push_back(partition_length);
-            partition_areas.push_back(partition_length * partition_length);
-        }
-
         size_t num_elements = num_rows * num_cols;
 #pragma omp parallel for schedule(static)
         for (size_t idx = 0; idx < num_elements; ++idx) {
-            size_t x = idx % num_cols;
-            size_t y = idx / num_cols;
-
-            size_t hierarchy_idx = 0;
-            for (size_t size_idx = 0; size_idx < depth; ++size_idx) {
-                size_t partition_x = x / partition_lengths[size_idx];
-                size_t partition_y = y / partition_lengths[size_idx];
-
-                hierarchy_idx += (partition_x + partition_y * 2) * partition_areas[size_idx];
-                x %= partition_lengths[size_idx];
-                y %= partition_lengths[size_idx];
-            }
-
-            destination[hierarchy_idx] = source[idx];
+            destination[ldg::mortonIndex(idx / num_cols, idx % num_cols)] = source[idx];
         }
     }
 }
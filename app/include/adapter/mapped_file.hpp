@@ -0,0 +1,113 @@
+#ifndef LDG_CORE_MAPPED_FILE_HPP
+#define LDG_CORE_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace adapter
+{
+    /**
+     * Get the range of pages that a range of memory lies in.
+     *
+     * @param address
+     * @param len
+     * @return [start, end) addresses of the pages.
+     */
+    inline std::pair<uintptr_t, uintptr_t> getPageRange(const void *address, size_t len)
+    {
+        static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto start = reinterpret_cast<uintptr_t>(address) / page_size * page_size;
+        auto end = (reinterpret_cast<uintptr_t>(address) + len + page_size - 1) / page_size * page_size;
+        return { start, end };
+    }
+
+    /**
+     * Read-only memory map of a whole file. Pages are loaded on access and can be evicted by the kernel at any time,
+     * such that files larger than the physical memory can be used. Check isMapped() to see if mapping succeeded.
+     */
+    class MappedFile
+    {
+        void *address = MAP_FAILED;
+        size_t len = 0;
+
+    public:
+        explicit MappedFile(std::string const &file_name);
+
+        MappedFile(MappedFile const &) = delete;
+
+        MappedFile &operator=(MappedFile const &) = delete;
+
+        ~MappedFile();
+
+        bool isMapped() const;
+
+        const void *data() const;
+
+        size_t size() const;
+    };
+
+    /**
+     * Map a file into memory. Errors are reported and result in an unmapped file.
+     *
+     * @param file_name
+     */
+    inline MappedFile::MappedFile(std::string const &file_name)
+    {
+        int file_descriptor = open(file_name.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+            std::cerr << "Could not open file: " << file_name << std::endl;
+            return;
+        }
+
+        struct stat file_stat{};
+        if (fstat(file_descriptor, &file_stat) == 0 && file_stat.st_size > 0) {
+            len = file_stat.st_size;
+            address = mmap(nullptr, len, PROT_READ, MAP_SHARED, file_descriptor, 0);
+        }
+        close(file_descriptor);     // The mapping keeps its own reference to the file
+
+        if (address == MAP_FAILED) {
+            std::cerr << "Could not map file: " << file_name << std::endl;
+            len = 0;
+        }
+    }
+
+    inline MappedFile::~MappedFile()
+    {
+        if (address != MAP_FAILED)
+            munmap(address, len);
+    }
+
+    /**
+     * @return
+     */
+    inline bool MappedFile::isMapped() const
+    {
+        return address != MAP_FAILED;
+    }
+
+    /**
+     * @return Start of the mapped file, or nullptr if the file is not mapped.
+     */
+    inline const void *MappedFile::data() const
+    {
+        return isMapped() ? address : nullptr;
+    }
+
+    /**
+     * @return Size of the mapped file in bytes.
+     */
+    inline size_t MappedFile::size() const
+    {
+        return len;
+    }
+}
+
+#endif //LDG_CORE_MAPPED_FILE_HPP
@@ -0,0 +1,164 @@
+#ifndef LDG_CORE_REDUCTION_HPP
+#define LDG_CORE_REDUCTION_HPP
+
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <Eigen/Dense>
+#include "app/include/ldg/model/feature_matrix.hpp"
+#include "reduction_type.hpp"
+
+namespace adapter
+{
+    constexpr Eigen::Index PCA_OVERSAMPLING = 10;       // Extra sketch dimensions for the randomized PCA.
+    constexpr size_t PCA_NUM_POWER_ITERATIONS = 2;
+    constexpr Eigen::Index REDUCTION_BLOCK_LEN = 4096;  // Number of elements projected at once.
+
+    /**
+     * Create a matrix with independent standard normal entries.
+     *
+     * @tparam Scalar
+     * @param num_rows
+     * @param num_cols
+     * @param generator
+     * @return
+     */
+    template<typename Scalar>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> createGaussianMatrix(Eigen::Index num_rows, Eigen::Index num_cols, std::mt19937 &generator)
+    {
+        std::normal_distribution<Scalar> distribution(0, 1);
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> matrix(num_rows, num_cols);
+        for (Eigen::Index idx = 0; idx < matrix.size(); ++idx) {
+            matrix.data()[idx] = distribution(generator);
+        }
+        return matrix;
+    }
+
+    /**
+     * Compute an orthonormal basis for the column space of a tall matrix.
+     *
+     * @tparam Scalar
+     * @param matrix
+     * @return
+     */
+    template<typename Scalar>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> orthonormalize(Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> const &matrix)
+    {
+        Eigen::HouseholderQR<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> qr(matrix);
+        return qr.householderQ() * Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Identity(matrix.rows(), matrix.cols());
+    }
+
+    /**
+     * Compute the leading principal components of the elements using a randomized range finder (Halko et al.).
+     * The centered data is never materialized and only a (sketch length x data length) matrix is decomposed, such that this
+     * also works for very wide elements. Components that do not exist, e.g. because there are fewer elements, are left at zero.
+     *
+     * @tparam Scalar
+     * @tparam Derived
+     * @param elements Matrix where every row is an element.
+     * @param mean Mean of the rows of the elements.
+     * @param num_components
+     * @param generator
+     * @return A (data length x num_components) projection matrix.
+     */
+    template<typename Scalar, typename Derived>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> computePrincipalComponents(
+        Eigen::MatrixBase<Derived> const &elements,
+        Eigen::Matrix<Scalar, 1, Eigen::Dynamic> const &mean,
+        Eigen::Index num_components,
+        std::mt19937 &generator
+    ) {
+        using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+        Eigen::Index sketch_len = std::min({ elements.rows(), elements.cols(), num_components + PCA_OVERSAMPLING });
+
+        // Sketch the range of the centered data and refine it with a couple of power iterations
+        Matrix gaussian = createGaussianMatrix<Scalar>(elements.cols(), sketch_len, generator);
+        Matrix sketch = elements * gaussian;
+        sketch.rowwise() -= mean * gaussian;
+        for (size_t iteration = 0; iteration < PCA_NUM_POWER_ITERATIONS; ++iteration) {
+            Matrix basis = orthonormalize<Scalar>(sketch);
+            Matrix co_sketch = elements.transpose() * basis - mean.transpose() * basis.colwise().sum();
+            co_sketch = orthonormalize<Scalar>(co_sketch);
+            sketch = elements * co_sketch;
+            sketch.rowwise() -= mean * co_sketch;
+        }
+
+        // Project the centered data onto the sketch basis and decompose the small projected matrix
+        Matrix basis = orthonormalize<Scalar>(sketch);
+        Matrix projected = basis.transpose() * elements - basis.colwise().sum().transpose() * mean;
+        Eigen::SelfAdjointEigenSolver<Matrix> solver(projected * projected.transpose());
+
+        // Eigenvalues are sorted in increasing order, so the leading components are at the end
+        Matrix components = Matrix::Zero(elements.cols(), num_components);
+        for (Eigen::Index component = 0; component < std::min(num_components, sketch_len); ++component) {
+            Eigen::Index eigen_idx = sketch_len - 1 - component;
+            Scalar singular_value = std::sqrt(std::max(solver.eigenvalues()[eigen_idx], Scalar(0)));
+            if (singular_value > Eigen::NumTraits<Scalar>::dummy_precision()) {
+                components.col(component) = projected.transpose() * solver.eigenvectors().col(eigen_idx) / singular_value;
+            }
+        }
+
+        return components;
+    }
+
+    /**
+     * Create reduced sorting features from the full-resolution data. The first num_elements rows are projected, while the
+     * other rows keep their void state and are initialized to 0, similar to the loaded data.
+     * The projection is seeded such that the same features are created for the same seed.
+     *
+     * @tparam VectorType Vector type of the reduced features.
+     * @tparam SourceVectorType Vector type of the full-resolution data.
+     * @param source
+     * @param num_elements
+     * @param reduced_len
+     * @param reduction_type
+     * @param seed
+     * @return
+     */
+    template<typename VectorType, typename SourceVectorType>
+    ldg::FeatureMatrix<VectorType> reduceData(
+        ldg::FeatureMatrix<SourceVectorType> const &source,
+        size_t num_elements,
+        size_t reduced_len,
+        ReductionType reduction_type,
+        size_t seed
+    ) {
+        using Scalar = typename VectorType::Scalar;
+        static_assert(std::is_same_v<Scalar, typename SourceVectorType::Scalar>, "Features must be reduced in the type of the data");
+        static_assert(std::is_floating_point_v<Scalar>, "Features can only be reduced into floating point types");
+
+        std::mt19937 generator(seed);
+        auto elements = source.getBlock(num_elements);
+        Eigen::Matrix<Scalar, 1, Eigen::Dynamic> offset = Eigen::Matrix<Scalar, 1, Eigen::Dynamic>::Zero(reduced_len);
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> projection;
+        if (reduction_type == ReductionType::PCA) {
+            Eigen::Matrix<Scalar, 1, Eigen::Dynamic> mean = elements.colwise().mean();
+            projection = computePrincipalComponents<Scalar>(elements, mean, reduced_len, generator);
+            offset = mean * projection;
+        } else {
+            // Scaled such that squared distances are preserved in expectation
+            projection = createGaussianMatrix<Scalar>(elements.cols(), reduced_len, generator) / std::sqrt(Scalar(reduced_len));
+        }
+
+        ldg::FeatureMatrix<VectorType> features(source.size(), reduced_len);
+#pragma omp parallel for schedule(static)
+        for (Eigen::Index start = 0; start < Eigen::Index(num_elements); start += REDUCTION_BLOCK_LEN) {
+            Eigen::Index len = std::min(REDUCTION_BLOCK_LEN, Eigen::Index(num_elements) - start);
+            Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> block = elements.middleRows(start, len) * projection;
+            block.rowwise() -= offset;
+            for (Eigen::Index row = 0; row < len; ++row) {
+                if (!source.isVoid(start + row))
+                    features.setRow(start + row, block.row(row).transpose());
+            }
+        }
+        for (size_t row = num_elements; row < source.size(); ++row) {
+            if (!source.isVoid(row))
+                features.setRow(row, VectorType::Zero(reduced_len));
+        }
+
+        return features;
+    }
+}
+
+#endif //LDG_CORE_REDUCTION_HPP
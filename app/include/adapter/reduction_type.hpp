@@ -0,0 +1,17 @@
+#ifndef LDG_CORE_REDUCTION_TYPE_HPP
+#define LDG_CORE_REDUCTION_TYPE_HPP
+
+namespace adapter
+{
+    /**
+     * Types of dimensionality reduction used to create the sorting features from the data.
+     */
+    enum ReductionType
+    {
+        NONE,                   // Sort on the full-resolution data
+        PCA,                    // Projection onto the leading principal components
+        RANDOM_PROJECTION       // Gaussian random projection
+    };
+}
+
+#endif //LDG_CORE_REDUCTION_TYPE_HPP
@@ -3,6 +3,9 @@
 
 #include <bzlib.h>
 #include <string>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 #include "data_layout.hpp"
 #include "app/include/ldg/util/tree_functions.hpp"
@@ -101,6 +104,72 @@ namespace adapter
         return -1;
     }
 
+    /**
+     * Decompress a .bz2 file into a file on disk. The data is streamed in chunks, so it never has to fit in memory.
+     * The output is written to a temporary file first, such that an interrupted decompression does not leave a partial file.
+     *
+     * @param file_name
+     * @param output_file_name
+     * @return False if decompressing failed.
+     */
+    inline bool decompressBZipFileToFile(std::string const &file_name, std::string const &output_file_name)
+    {
+        FILE *input_file = fopen(file_name.c_str(), "rb");
+        if (input_file == nullptr) {
+            std::cerr << "Could not open file: " << file_name << std::endl;
+            return false;
+        }
+
+        std::string temporary_file_name = output_file_name + ".tmp";
+        std::ofstream output_stream(temporary_file_name, std::ios::binary);
+        if (!output_stream.is_open()) {
+            std::cerr << "Could not open file: " << temporary_file_name << std::endl;
+            fclose(input_file);
+            return false;
+        }
+
+        int bz_error;
+        BZFILE *bz_file = BZ2_bzReadOpen(&bz_error, input_file, 0, 0, nullptr, 0);
+        std::vector<char> chunk(1 << 20);
+        while (bz_error == BZ_OK) {
+            int num_read = BZ2_bzRead(&bz_error, bz_file, chunk.data(), static_cast<int>(chunk.size()));
+            if (bz_error == BZ_OK || bz_error == BZ_STREAM_END)
+                output_stream.write(chunk.data(), num_read);
+        }
+        int close_error;
+        BZ2_bzReadClose(&close_error, bz_file);
+        fclose(input_file);
+        output_stream.close();
+
+        if (bz_error != BZ_STREAM_END || !output_stream) {
+            std::cerr << "Could not decompress file: " << file_name << std::endl;
+            std::remove(temporary_file_name.c_str());
+            return false;
+        }
+        return std::rename(temporary_file_name.c_str(), output_file_name.c_str()) == 0;
+    }
+
+    /**
+     * Get the path to a decompressed version of a .bz2 file, which is cached next to it as "<file_name>.cache".
+     * The cache is (re)created if it does not exist or is older than the compressed file.
+     *
+     * @param file_name
+     * @return Path to the cache, or an empty string if it could not be created.
+     */
+    inline std::string getDecompressedCache(std::string const &file_name)
+    {
+        std::string cache_file_name = file_name + ".cache";
+        std::error_code cache_error, file_error;
+        auto cache_time = std::filesystem::last_write_time(cache_file_name, cache_error);
+        auto file_time = std::filesystem::last_write_time(file_name, file_error);
+        if (cache_error || file_error || cache_time < file_time) {
+            std::cout << "Decompressing " << file_name << " into " << cache_file_name << std::endl;
+            if (!decompressBZipFileToFile(file_name, cache_file_name))
+                return "";
+        }
+        return cache_file_name;
+    }
+
     /**
      * Write a compressed stream to a BZ2 file.
      *
@@ -153,7 +222,13 @@ namespace adapter
     {
         size_t grid_side_len = std::pow(2, std::ceil(std::log2(std::max(quad_tree.getNumRows(), quad_tree.getNumCols()))));
         std::vector assignment(grid_side_len * grid_side_len, VOID_TILE_IDX);
-        copyFromRowMajorToHierarchy(quad_tree.getAssignment(), assignment, quad_tree.getNumRows(), quad_tree.getNumCols());
+        if (quad_tree.getLayout() == ldg::LayoutType::Z_ORDER && quad_tree.getNumRows() == quad_tree.getNumCols()) {
+            // The hierarchical layout of square grids is exactly the Z-order layout
+            std::copy(quad_tree.getAssignment().begin(), quad_tree.getAssignment().end(), assignment.begin());
+        } else {
+            auto row_major_assignment = quad_tree.getRowMajorAssignment();
+            copyFromRowMajorToHierarchy(row_major_assignment, assignment, quad_tree.getNumRows(), quad_tree.getNumCols());
+        }
 
         // Add void tiles where the data refers to nullptrs
         for (uint32_t &value: assignment) {
@@ -180,20 +255,16 @@ namespace adapter
         std::vector<uint32_t> hierarchical_assignment(max_pow2_dim * max_pow2_dim);
         readFileIntoBuffer(hierarchical_assignment, filename);
 
-        size_t required_assignment_capacity = ldg::determineRequiredArrayCapacity(num_rows, num_cols);
-        std::vector<size_t> row_major_assignment(required_assignment_capacity);
+        size_t num_leafs = num_rows * num_cols;
+        std::vector<size_t> row_major_assignment(num_leafs);
         copyFromHierarchyToRowMajor(hierarchical_assignment, row_major_assignment, num_rows, num_cols);
 
-        // Replace all void tiles with the end of the data array (assumed to be nullptrs) and give aggregates an assignment.
+        // Replace all void tiles with the end of the data array (assumed to be nullptrs). Aggregates are not assigned.
         size_t next_void_tile_placement = num_actual_elements;
-        size_t num_leafs = num_rows * num_cols;
-        for (size_t idx = 0; idx < required_assignment_capacity; ++idx) {
+        for (size_t idx = 0; idx < num_leafs; ++idx) {
             if (row_major_assignment[idx] == VOID_TILE_IDX) {
                 row_major_assignment[idx] = next_void_tile_placement++;
             }
-            if (idx >= num_leafs) {
-                row_major_assignment[idx] = idx;
-            }
         }
 
         return row_major_assignment;
@@ -0,0 +1,179 @@
+#ifndef LDG_CORE_TILE_SCHEDULER_HPP
+#define LDG_CORE_TILE_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "mapped_file.hpp"
+
+namespace adapter
+{
+    /**
+     * Keeps the data of a band of grid rows resident while it is being processed, for quad trees whose data elements are
+     * mapped from a file. Upcoming bands are prefetched, while processed bands are released such that the resident set
+     * stays bounded. The norms of mapped elements are computed when their band is first processed, rather than reading the
+     * whole file up front. For in-memory data the scheduler is inactive and does nothing.
+     * As the leaves of a band are assigned data elements from all over the file, the pages of a band are collected and merged
+     * into runs first, such that the kernel is advised once per run rather than once per leaf. Pages that the last prefetched
+     * band shares with a released band are kept.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    class TileScheduler
+    {
+        using PageRuns = std::vector<std::pair<uintptr_t, uintptr_t>>;
+
+        ldg::QuadAssignmentTree<VectorType> &quad_tree;
+        PageRuns prefetched_pages;  // Page runs of the band that was prefetched last.
+
+        PageRuns collectPages(long start_row, long end_row) const;
+
+    public:
+        explicit TileScheduler(ldg::QuadAssignmentTree<VectorType> &quad_tree);
+
+        bool isActive() const;
+
+        void prefetch(long start_row, long end_row);
+
+        void cacheNorms(long start_row, long end_row);
+
+        void release(long start_row, long end_row);
+    };
+
+    /**
+     * @tparam VectorType
+     * @param quad_tree
+     */
+    template<typename VectorType>
+    TileScheduler<VectorType>::TileScheduler(ldg::QuadAssignmentTree<VectorType> &quad_tree):
+        quad_tree(quad_tree)
+    {}
+
+    /**
+     * @tparam VectorType
+     * @return True if the data elements of the quad tree are mapped.
+     */
+    template<typename VectorType>
+    bool TileScheduler<VectorType>::isActive() const
+    {
+        return quad_tree.getData().getNumExternalRows() > 0;
+    }
+
+    /**
+     * Collect the pages of the mapped data elements assigned to the leaves in [start_row, end_row) of the grid as sorted runs of
+     * consecutive pages. Rows outside the grid are ignored.
+     *
+     * @tparam VectorType
+     * @param start_row
+     * @param end_row
+     * @return Sorted, disjoint [start, end) addresses of the runs.
+     */
+    template<typename VectorType>
+    typename TileScheduler<VectorType>::PageRuns TileScheduler<VectorType>::collectPages(long start_row, long end_row) const
+    {
+        auto &data = quad_tree.getData();
+        long num_cols = static_cast<long>(quad_tree.getNumCols());
+        start_row = std::max(start_row, 0l);
+        end_row = std::min(end_row, static_cast<long>(quad_tree.getNumRows()));
+
+        PageRuns pages;
+        for (long idx = start_row * num_cols; idx < end_row * num_cols; ++idx) {
+            size_t data_row = quad_tree.getAssignmentValue({ 0, static_cast<size_t>(idx) });
+            if (data_row < data.getNumExternalRows()) {
+                auto view = data.getRow(data_row);
+                pages.push_back(getPageRange(view.data(), view.size() * sizeof(typename VectorType::Scalar)));
+            }
+        }
+        std::sort(pages.begin(), pages.end());
+
+        // Merge overlapping and adjacent ranges
+        PageRuns runs;
+        for (auto const &range : pages) {
+            if (!runs.empty() && range.first <= runs.back().second)
+                runs.back().second = std::max(runs.back().second, range.second);
+            else
+                runs.push_back(range);
+        }
+        return runs;
+    }
+
+    /**
+     * Start loading the data of a band of grid rows in the background.
+     *
+     * @tparam VectorType
+     * @param start_row
+     * @param end_row
+     */
+    template<typename VectorType>
+    void TileScheduler<VectorType>::prefetch(long start_row, long end_row)
+    {
+        if (!isActive())
+            return;
+
+        prefetched_pages = collectPages(start_row, end_row);
+        for (auto const &[start, end] : prefetched_pages)
+            madvise(reinterpret_cast<void *>(start), end - start, MADV_WILLNEED);
+    }
+
+    /**
+     * Compute the norms of the mapped data elements assigned to the leaves in [start_row, end_row) of the grid that are not known yet.
+     * This should be called right before the band is processed, as it reads the data of the band.
+     *
+     * @tparam VectorType
+     * @param start_row
+     * @param end_row
+     */
+    template<typename VectorType>
+    void TileScheduler<VectorType>::cacheNorms(long start_row, long end_row)
+    {
+        if (!isActive())
+            return;
+
+        auto &data = quad_tree.getData();
+        long num_cols = static_cast<long>(quad_tree.getNumCols());
+        start_row = std::max(start_row, 0l);
+        end_row = std::min(end_row, static_cast<long>(quad_tree.getNumRows()));
+
+        // Every leaf holds a different data element, so the norms can be computed concurrently.
+#pragma omp parallel for schedule(static)
+        for (long idx = start_row * num_cols; idx < end_row * num_cols; ++idx) {
+            size_t data_row = quad_tree.getAssignmentValue({ 0, static_cast<size_t>(idx) });
+            if (data_row < data.getNumExternalRows() && !data.getRow(data_row).hasNorm())
+                data.updateNorm(data_row);
+        }
+    }
+
+    /**
+     * Release the data of a band of grid rows, except for the pages of the band that was prefetched last.
+     * The mapping is read-only, so released pages are simply read again when needed.
+     *
+     * @tparam VectorType
+     * @param start_row
+     * @param end_row
+     */
+    template<typename VectorType>
+    void TileScheduler<VectorType>::release(long start_row, long end_row)
+    {
+        if (!isActive())
+            return;
+
+        // Both lists of runs are sorted, so the prefetched runs can be cut out of the released runs in a single sweep
+        auto prefetched = prefetched_pages.begin();
+        for (auto [start, end] : collectPages(start_row, end_row)) {
+            while (prefetched != prefetched_pages.end() && prefetched->second <= start)
+                ++prefetched;
+            for (auto kept = prefetched; kept != prefetched_pages.end() && kept->first < end; ++kept) {
+                if (start < kept->first)
+                    madvise(reinterpret_cast<void *>(start), kept->first - start, MADV_DONTNEED);
+                start = std::max(start, kept->second);
+            }
+            if (start < end)
+                madvise(reinterpret_cast<void *>(start), end - start, MADV_DONTNEED);
+        }
+    }
+}
+
+#endif //LDG_CORE_TILE_SCHEDULER_HPP
@@ -0,0 +1,287 @@
+#ifndef LDG_CORE_FEATURE_MATRIX_HPP
+#define LDG_CORE_FEATURE_MATRIX_HPP
+
+#include "vector_view.hpp"
+#include "app/include/ldg/util/metric/kernels.hpp"
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <Eigen/Core>
+
+namespace ldg
+{
+    /**
+     * Contiguous storage for all data vectors of the quad tree.
+     * Vectors are stored as rows of one aligned row-major buffer, where every row is padded to the alignment boundary.
+     * Rows can be marked as void, which is the equivalent of a nullptr data element.
+     * The L2 norm of every row is cached. It is updated when a row is set, but rows written through a mutable map need an explicit update.
+     * Optionally, the first rows are read-only external rows (e.g. a memory-mapped file) without padding, which are kept
+     * alive by a shared owner. All other rows are stored in the owned buffer. The norms of external rows are unknown until
+     * they are explicitly updated, such that the external memory is not read up front.
+     *
+     * @tparam VectorType The (Eigen) vector type of a single row.
+     */
+    template<typename VectorType>
+    class FeatureMatrix
+    {
+        using Scalar = typename VectorType::Scalar;
+        using BlockType = Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>, 0, Eigen::OuterStride<>>;
+
+        size_t num_vectors;
+        size_t element_len;
+        size_t stride;      // Number of scalars between the start of two rows.
+
+        std::vector<Scalar, Eigen::aligned_allocator<Scalar>> buffer;
+        std::shared_ptr<const void> external_owner;
+        const Scalar *external_rows = nullptr;
+        size_t num_external_rows = 0;
+        std::vector<uint8_t> is_set;    // Byte flags instead of bools to allow concurrent writes to different rows.
+        std::vector<double> norms;
+
+    public:
+        FeatureMatrix();
+
+        FeatureMatrix(size_t num_vectors, size_t element_len);
+
+        FeatureMatrix(size_t num_vectors, size_t element_len, std::shared_ptr<const void> external_owner, const Scalar *external_rows, size_t num_external_rows);
+
+        size_t size() const;
+
+        size_t getNumExternalRows() const;
+
+        size_t getElementLen() const;
+
+        size_t getStride() const;
+
+        VectorView<VectorType> getRow(size_t row) const;
+
+        BlockType getBlock(size_t num_rows) const;
+
+        Eigen::Map<VectorType> getMutableRow(size_t row);
+
+        template<typename Derived>
+        void setRow(size_t row, Eigen::MatrixBase<Derived> const &value);
+
+        void clearRow(size_t row);
+
+        void updateNorm(size_t row);
+
+        bool isVoid(size_t row) const;
+    };
+
+    /**
+     * Create an empty matrix.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    FeatureMatrix<VectorType>::FeatureMatrix():
+        num_vectors(0),
+        element_len(0),
+        stride(0)
+    {}
+
+    /**
+     * Create a zero-initialized matrix where all rows are void.
+     *
+     * @tparam VectorType
+     * @param num_vectors
+     * @param element_len
+     */
+    template<typename VectorType>
+    FeatureMatrix<VectorType>::FeatureMatrix(size_t num_vectors, size_t element_len):
+        num_vectors(num_vectors),
+        element_len(element_len),
+        is_set(num_vectors, 0),
+        norms(num_vectors, 0.)
+    {
+        size_t row_alignment = std::max<size_t>(1, EIGEN_MAX_ALIGN_BYTES / sizeof(Scalar));
+        stride = (element_len + row_alignment - 1) / row_alignment * row_alignment;
+        buffer.resize(num_vectors * stride, Scalar(0));
+    }
+
+    /**
+     * Create a matrix where the first rows are read from external memory, which must hold num_external_rows consecutive
+     * unpadded rows. The external rows are non-void with an unknown norm, while all other rows are zero-initialized and void.
+     * Only the other rows are allocated.
+     *
+     * @tparam VectorType
+     * @param num_vectors
+     * @param element_len
+     * @param external_owner Keeps the external memory alive.
+     * @param external_rows
+     * @param num_external_rows
+     */
+    template<typename VectorType>
+    FeatureMatrix<VectorType>::FeatureMatrix(
+        size_t num_vectors,
+        size_t element_len,
+        std::shared_ptr<const void> external_owner,
+        const Scalar *external_rows,
+        size_t num_external_rows
+    ):
+        num_vectors(num_vectors),
+        element_len(element_len),
+        external_owner(std::move(external_owner)),
+        external_rows(external_rows),
+        num_external_rows(std::min(num_external_rows, num_vectors)),
+        is_set(num_vectors, 0),
+        norms(num_vectors, 0.)
+    {
+        size_t row_alignment = std::max<size_t>(1, EIGEN_MAX_ALIGN_BYTES / sizeof(Scalar));
+        stride = (element_len + row_alignment - 1) / row_alignment * row_alignment;
+        buffer.resize((num_vectors - this->num_external_rows) * stride, Scalar(0));
+        std::fill(is_set.begin(), is_set.begin() + this->num_external_rows, 1);
+        std::fill(norms.begin(), norms.begin() + this->num_external_rows, -1.);
+    }
+
+    /**
+     * @tparam VectorType
+     * @return The number of rows in the matrix.
+     */
+    template<typename VectorType>
+    size_t FeatureMatrix<VectorType>::size() const
+    {
+        return num_vectors;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return The number of read-only rows at the start of the matrix that are stored externally.
+     */
+    template<typename VectorType>
+    size_t FeatureMatrix<VectorType>::getNumExternalRows() const
+    {
+        return num_external_rows;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    size_t FeatureMatrix<VectorType>::getElementLen() const
+    {
+        return element_len;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    size_t FeatureMatrix<VectorType>::getStride() const
+    {
+        return stride;
+    }
+
+    /**
+     * Get a view of a row. Void rows result in an empty view.
+     *
+     * @tparam VectorType
+     * @param row
+     * @return
+     */
+    template<typename VectorType>
+    VectorView<VectorType> FeatureMatrix<VectorType>::getRow(size_t row) const
+    {
+        if (!is_set[row])
+            return nullptr;
+        if (row < num_external_rows)
+            return VectorView<VectorType>(external_rows + row * element_len, element_len, norms[row]);
+        return VectorView<VectorType>(buffer.data() + (row - num_external_rows) * stride, element_len, norms[row]);
+    }
+
+    /**
+     * Get a read-only map of the first rows as a single row-major matrix, skipping the row padding.
+     * Void rows are included as zero rows, as long as they were never set. The rows can not span both external and owned rows.
+     *
+     * @tparam VectorType
+     * @param num_rows
+     * @return
+     */
+    template<typename VectorType>
+    typename FeatureMatrix<VectorType>::BlockType FeatureMatrix<VectorType>::getBlock(size_t num_rows) const
+    {
+        if (num_external_rows > 0) {
+            if (num_rows > num_external_rows)
+                throw std::out_of_range("Block spans both external and owned rows");
+            return BlockType(external_rows, num_rows, element_len, Eigen::OuterStride<>(element_len));
+        }
+        return BlockType(buffer.data(), num_rows, element_len, Eigen::OuterStride<>(stride));
+    }
+
+    /**
+     * Get a writable map of a row, marking it as non-void. External rows are read-only and can not be written.
+     * The norm of the row should be updated after writing.
+     *
+     * @tparam VectorType
+     * @param row
+     * @return
+     */
+    template<typename VectorType>
+    Eigen::Map<VectorType> FeatureMatrix<VectorType>::getMutableRow(size_t row)
+    {
+        eigen_assert(row >= num_external_rows);
+        is_set[row] = 1;
+        return Eigen::Map<VectorType>(buffer.data() + (row - num_external_rows) * stride, element_len);
+    }
+
+    /**
+     * Overwrite a row with a value, marking it as non-void, and update its norm.
+     *
+     * @tparam VectorType
+     * @tparam Derived
+     * @param row
+     * @param value
+     */
+    template<typename VectorType>
+    template<typename Derived>
+    void FeatureMatrix<VectorType>::setRow(size_t row, Eigen::MatrixBase<Derived> const &value)
+    {
+        getMutableRow(row) = value;
+        updateNorm(row);
+    }
+
+    /**
+     * Mark a row as void.
+     *
+     * @tparam VectorType
+     * @param row
+     */
+    template<typename VectorType>
+    void FeatureMatrix<VectorType>::clearRow(size_t row)
+    {
+        is_set[row] = 0;
+    }
+
+    /**
+     * Recompute the cached norm of a row, for example after it was written through a mutable map.
+     *
+     * @tparam VectorType
+     * @param row
+     */
+    template<typename VectorType>
+    void FeatureMatrix<VectorType>::updateNorm(size_t row)
+    {
+        auto view = getRow(row);
+        norms[row] = view == nullptr ? 0. : ldg::norm(*view);
+    }
+
+    /**
+     * @tparam VectorType
+     * @param row
+     * @return
+     */
+    template<typename VectorType>
+    bool FeatureMatrix<VectorType>::isVoid(size_t row) const
+    {
+        return !is_set[row];
+    }
+}
+
+#endif //LDG_CORE_FEATURE_MATRIX_HPP
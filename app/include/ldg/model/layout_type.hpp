@@ -0,0 +1,33 @@
+#ifndef LDG_SSM_LAYOUT_TYPE_HPP
+#define LDG_SSM_LAYOUT_TYPE_HPP
+
+#include <bit>
+#include <cstddef>
+
+namespace ldg
+{
+    /**
+     * Memory layout of the per-height arrays of the quad tree.
+     * Positions are always addressed by their row-major index; the layout only determines where a position is stored.
+     */
+    enum LayoutType {
+        ROW_MAJOR,
+        Z_ORDER     // Every partition is a contiguous range. Only supported for grids with power of two dimensions.
+    };
+
+    /**
+     * Check if a layout can be used for a grid. The Z-order layout requires both dimensions to be powers of two, such that
+     * every height can be stored without gaps.
+     *
+     * @param layout
+     * @param num_rows
+     * @param num_cols
+     * @return
+     */
+    inline bool supportsLayout(LayoutType layout, size_t num_rows, size_t num_cols)
+    {
+        return layout == LayoutType::ROW_MAJOR || (std::has_single_bit(num_rows) && std::has_single_bit(num_cols));
+    }
+}
+
+#endif //LDG_SSM_LAYOUT_TYPE_HPP
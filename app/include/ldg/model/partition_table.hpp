@@ -0,0 +1,128 @@
+#ifndef LDG_CORE_PARTITION_TABLE_HPP
+#define LDG_CORE_PARTITION_TABLE_HPP
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+#include "app/include/ldg/util/math.hpp"
+
+namespace ldg
+{
+    /**
+     * Indirection table of the partitions at a height, which records per partition the partition whose subtree is stored there.
+     * Exchanging whole subtrees only updates the table, while reads of the nodes below the partitions are redirected through it.
+     * An empty table (height 0) redirects nothing.
+     */
+    class PartitionTable
+    {
+        size_t height = 0;
+        size_t num_partition_cols = 0;
+        std::vector<size_t> sources;    // Per partition in row-major order, the partition that stores its subtree.
+
+    public:
+        void reset(size_t height, size_t num_partition_rows, size_t num_partition_cols);
+
+        void clear();
+
+        bool isEmpty() const;
+
+        size_t getHeight() const;
+
+        size_t getSource(size_t partition) const;
+
+        void setSource(size_t partition, size_t source);
+
+        size_t resolve(size_t height, size_t index, size_t num_cols) const;
+    };
+
+    /**
+     * Create an identity table for the partitions at a height.
+     *
+     * @param height
+     * @param num_partition_rows
+     * @param num_partition_cols
+     */
+    inline void PartitionTable::reset(size_t height, size_t num_partition_rows, size_t num_partition_cols)
+    {
+        this->height = height;
+        this->num_partition_cols = num_partition_cols;
+        sources.resize(num_partition_rows * num_partition_cols);
+        std::iota(sources.begin(), sources.end(), 0);
+    }
+
+    /**
+     * Remove the table, such that nothing is redirected anymore.
+     */
+    inline void PartitionTable::clear()
+    {
+        height = 0;
+        num_partition_cols = 0;
+        sources.clear();
+    }
+
+    /**
+     * @return True if the table does not redirect anything.
+     */
+    inline bool PartitionTable::isEmpty() const
+    {
+        return height == 0;
+    }
+
+    /**
+     * @return The height of the partitions in the table.
+     */
+    inline size_t PartitionTable::getHeight() const
+    {
+        return height;
+    }
+
+    /**
+     * @param partition
+     * @return The partition that stores the subtree of a partition.
+     */
+    inline size_t PartitionTable::getSource(size_t partition) const
+    {
+        return sources[partition];
+    }
+
+    /**
+     * Store the subtree of a partition in a source partition. All sources should stay unique and have the same shape as the
+     * partition they are stored for. This is safe to call concurrently for different partitions.
+     *
+     * @param partition
+     * @param source
+     */
+    inline void PartitionTable::setSource(size_t partition, size_t source)
+    {
+        sources[partition] = source;
+    }
+
+    /**
+     * Redirect the row-major index of a node at or below the height of the table to the index of the node that stores it, which
+     * has the same offset within the source partition.
+     *
+     * @param height    Height of the node.
+     * @param index Row-major index of the node.
+     * @param num_cols  Number of columns at the height of the node.
+     * @return
+     */
+    inline size_t PartitionTable::resolve(size_t height, size_t index, size_t num_cols) const
+    {
+        if (height > this->height)
+            return index;
+
+        size_t shift = this->height - height;
+        size_t row = index / num_cols;
+        size_t col = index % num_cols;
+        size_t partition = rowMajorIndex(row >> shift, col >> shift, num_partition_cols);
+        size_t source = sources[partition];
+        if (source == partition)
+            return index;
+
+        size_t source_row = ((source / num_partition_cols) << shift) + (row - ((row >> shift) << shift));
+        size_t source_col = ((source % num_partition_cols) << shift) + (col - ((col >> shift) << shift));
+        return rowMajorIndex(source_row, source_col, num_cols);
+    }
+}
+
+#endif //LDG_CORE_PARTITION_TABLE_HPP
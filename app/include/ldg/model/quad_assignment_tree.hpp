@@ -4,17 +4,33 @@
 #include "app/include/ldg/util/math.hpp"
 #include "cell_position.hpp"
 #include "parent_type.hpp"
+#include "layout_type.hpp"
+#include "feature_matrix.hpp"
+#include "partition_table.hpp"
+#include "vector_view.hpp"
 
+#include <array>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <cmath>
+#include <bit>
+#include <atomic>
+#include <algorithm>
+#include <utility>
 
 namespace ldg
 {
     /**
-     * Quad tree of the data. Uses a flat row-major data array for all heights of the tree, which should already exist.
-     * Uses an assignment array to determine the grid assignment.
+     * Quad tree of the data. Uses a flat row-major feature matrix for all heights of the tree, which should already exist.
+     * Uses an assignment array to determine the grid assignment of the leaves. Parents are not assigned, but are stored per height
+     * in preallocated rows of the feature matrix directly after the leaves and addressed by their position.
+     * Positions are addressed by their row-major index per height, which is mapped to a storage index based on the layout.
+     * In the Z-order layout, the assignment and parent rows of every partition form a contiguous range.
+     * Parents whose children changed since they were last computed are marked dirty, such that they can be updated incrementally.
+     * The parent and children of every node are precomputed in index tables, such that navigating the tree only requires lookups.
+     * Whole subtrees can be moved through a partition table, which redirects the nodes below a height until it is resolved.
      * @tparam VectorType The data type of the grid.
      */
     template<typename VectorType>
@@ -27,20 +43,34 @@ namespace ldg
         std::array<size_t, 3> data_dims;
 
         ParentType parent_type;
-        std::vector<std::shared_ptr<VectorType>> data;
-        std::vector<size_t> assignment;
+        LayoutType layout;
+        FeatureMatrix<VectorType> data;
+        std::vector<size_t> assignment;     // Leaf assignment in storage order.
         std::vector<std::pair<std::pair<size_t, size_t>, std::pair<size_t, size_t>>> bounds_cache;
+        std::vector<std::pair<size_t, size_t>> z_order_bits_cache;  // Per height, the number of bits of [the column count, the side of a Z-order block].
+        std::vector<size_t> parent_index_cache;             // Per node over all heights, the index of its parent.
+        std::vector<std::array<long, 4>> children_index_cache;  // Per parent over all heights, the [NW, NE, SW, SE] child indices or -1.
+        std::vector<uint8_t> dirty_flags;   // Per node in row-major order over all heights. Bytes allow concurrent updates.
+        bool all_dirty = true;
+        std::vector<uint32_t> node_versions;    // Per node in row-major order over all heights, the parent version it was last computed in.
+        uint32_t parent_version = 0;    // Number of times the parents were computed.
+        PartitionTable partition_table;
+
+        size_t getLayoutIndex(CellPosition position) const;
+
+        void getSubtreeIndices(size_t height, size_t partition, std::vector<size_t> &indices) const;
 
     public:
         QuadAssignmentTree(
-            const std::vector<std::shared_ptr<VectorType>> &data,
+            FeatureMatrix<VectorType> data,
             const std::vector<size_t> &assignment,
             size_t num_rows,
             size_t num_cols,
             size_t depth,
             size_t num_real_elements,
             std::array<size_t, 3> data_dims,
-            ParentType aggregation_type
+            ParentType aggregation_type,
+            LayoutType layout = LayoutType::ROW_MAJOR
         );
 
         size_t getDepth() const;
@@ -57,13 +87,23 @@ namespace ldg
 
         ParentType getParentType() const;
 
+        LayoutType getLayout() const;
+
+        size_t getStorageIndex(CellPosition position) const;
+
         std::vector<size_t> &getAssignment();
 
-        std::vector<std::shared_ptr<VectorType>> &getData();
+        std::vector<size_t> getRowMajorAssignment() const;
 
-        std::shared_ptr<VectorType> getValue(CellPosition position);
+        FeatureMatrix<VectorType> &getData();
 
-        bool setValue(CellPosition position, VectorType *value);
+        VectorView<VectorType> getValue(CellPosition position);
+
+        bool setParentValue(CellPosition position, VectorView<VectorType> value);
+
+        Eigen::Map<VectorType> getMutableParentValue(CellPosition position);
+
+        void updateParentNorm(CellPosition position);
 
         size_t getAssignmentValue(CellPosition position);
 
@@ -72,11 +112,37 @@ namespace ldg
         std::pair<std::pair<size_t, size_t>, std::pair<size_t, size_t>> getBounds(size_t height);
 
         std::pair<std::pair<size_t, size_t>, std::pair<size_t, size_t>> getLeafBounds(CellPosition position);
+
+        size_t getParentIndex(CellPosition position) const;
+
+        std::array<long, 4> const &getChildrenIndices(CellPosition position) const;
+
+        bool isDirty(CellPosition position) const;
+
+        void markParentDirty(CellPosition position);
+
+        void markAllDirty();
+
+        void clearDirty(CellPosition position);
+
+        void clearAllDirty();
+
+        uint32_t getParentVersion() const;
+
+        uint32_t getNodeVersion(CellPosition position) const;
+
+        void preparePartitionTable(size_t height);
+
+        size_t getPartitionSource(size_t partition) const;
+
+        void setPartitionSource(size_t partition, size_t source);
+
+        void resolvePartitionTable();
     };
 
     /**
      * Construct the quad tree from a data set. Assumes the data is already initialized using a [h0, h1, ...hn] structure.
-     * The assignment is initialized to the index of the tree.
+     * The assignment is given in row-major order and is converted to the layout. Unsupported layouts fall back to row-major.
      *
      * @tparam VectorType
      * @param data
@@ -85,27 +151,31 @@ namespace ldg
      * @param num_cols
      * @param depth
      * @param num_real_elements
-     * @param data_element_len
+     * @param data_dims
+     * @param aggregation_type
+     * @param layout
      */
     template<typename VectorType>
     QuadAssignmentTree<VectorType>::QuadAssignmentTree(
-        const std::vector<std::shared_ptr<VectorType>> &data,
+        FeatureMatrix<VectorType> data,
         const std::vector<size_t> &assignment,
         size_t num_rows,
         size_t num_cols,
         size_t depth,
         size_t num_real_elements,
         std::array<size_t, 3> data_dims,
-        ParentType aggregation_type
+        ParentType aggregation_type,
+        LayoutType layout
     ):
-        data(data),
+        data(std::move(data)),
         assignment(assignment),
         num_rows(num_rows),
         num_cols(num_cols),
         depth(depth),
         num_real_elements(num_real_elements),
         data_dims(data_dims),
-        parent_type(aggregation_type)
+        parent_type(aggregation_type),
+        layout(supportsLayout(layout, num_rows, num_cols) ? layout : LayoutType::ROW_MAJOR)
     {
         // Generate the bounds cache
         bounds_cache.reserve(depth);
@@ -123,12 +193,93 @@ namespace ldg
                     new_num_cols
                 }
             });
+            z_order_bits_cache.emplace_back(std::countr_zero(new_num_cols), std::countr_zero(std::min(new_num_rows, new_num_cols)));
             offset += new_num_cols * new_num_rows;
-            new_num_cols = ceilDivideByFactor(new_num_cols, 2.);
-            new_num_rows = ceilDivideByFactor(new_num_rows, 2.);
+            new_num_cols = ceilDivideByPowerTwo(new_num_cols, 1);
+            new_num_rows = ceilDivideByPowerTwo(new_num_rows, 1);
+        }
+
+        // Generate the parent and children index tables. Heights are independent, so every height is filled in parallel.
+        size_t num_leaves = num_rows * num_cols;
+        parent_index_cache.resize(offset, 0);
+        children_index_cache.resize(offset - num_leaves);
+        for (size_t height = 0; height < depth; ++height) {
+            auto [height_num_rows, height_num_cols] = bounds_cache[height].second;
+            size_t height_offset = bounds_cache[height].first.first;
+            size_t parent_num_cols = ceilDivideByPowerTwo(height_num_cols, 1);
+
+#pragma omp parallel for schedule(static)
+            for (size_t idx = 0; idx < height_num_rows * height_num_cols; ++idx) {
+                size_t row = idx / height_num_cols;
+                size_t col = idx % height_num_cols;
+                parent_index_cache[height_offset + idx] = rowMajorIndex(row >> 1, col >> 1, parent_num_cols);
+                if (height == 0)
+                    continue;
+
+                auto [child_num_rows, child_num_cols] = bounds_cache[height - 1].second;
+                size_t child_row = row << 1;
+                size_t child_col = col << 1;
+                long child_index = static_cast<long>(rowMajorIndex(child_row, child_col, child_num_cols));
+                bool has_east = child_col + 1 < child_num_cols;
+                bool has_south = child_row + 1 < child_num_rows;
+                children_index_cache[height_offset - num_leaves + idx] = {
+                    child_index,                                                            // North-west
+                    has_east ? child_index + 1 : -1,                                        // North-east
+                    has_south ? child_index + long(child_num_cols) : -1,                    // South-west
+                    has_east && has_south ? child_index + long(child_num_cols) + 1 : -1     // South-east
+                };
+            }
+        }
+
+        dirty_flags.resize(offset, 0);
+        node_versions.resize(offset, 0);
+
+        // Move the leaves to their storage index
+        if (this->layout != LayoutType::ROW_MAJOR) {
+            for (size_t idx = 0; idx < num_rows * num_cols; ++idx) {
+                this->assignment[getStorageIndex({ 0, idx })] = assignment[idx];
+            }
         }
     }
 
+    /**
+     * Map a position to its index in the storage of its height. Positions below the partition table are redirected to their source first.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return
+     */
+    template<typename VectorType>
+    size_t QuadAssignmentTree<VectorType>::getStorageIndex(CellPosition position) const
+    {
+        if (!partition_table.isEmpty())
+            position.index = partition_table.resolve(position.height, position.index, bounds_cache[position.height].second.second);
+        return getLayoutIndex(position);
+    }
+
+    /**
+     * Map a position to its index in the storage of its height according to the layout only.
+     * The Z-order layout consists of Z-ordered square blocks, which are placed after each other along the longest dimension.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return
+     */
+    template<typename VectorType>
+    size_t QuadAssignmentTree<VectorType>::getLayoutIndex(CellPosition position) const
+    {
+        if (layout == LayoutType::ROW_MAJOR)
+            return position.index;
+
+        // Dimensions are powers of two, so the row and column can be found by shifting
+        auto [col_bits, square_bits] = z_order_bits_cache[position.height];
+        size_t square_mask = (size_t(1) << square_bits) - 1;
+        size_t row = position.index >> col_bits;
+        size_t col = position.index & ((size_t(1) << col_bits) - 1);
+        size_t block = (row >> square_bits) + (col >> square_bits);   // At most one of these is non-zero
+        return (block << (2 * square_bits)) + mortonIndex(row & square_mask, col & square_mask);
+    }
+
     /**
      * Get the bounds of the data arrays for the given height.
      *
@@ -152,17 +303,12 @@ namespace ldg
     template<typename VectorType>
     std::pair<std::pair<size_t, size_t>, std::pair<size_t, size_t>> QuadAssignmentTree<VectorType>::getLeafBounds(CellPosition position)
     {
-        float factor = std::pow(2., position.height);
-        size_t height_num_cols = ceilDivideByFactor(num_cols, factor);
-        auto side_len = size_t(factor);
+        size_t height_num_cols = bounds_cache[position.height].second.second;
+        size_t side_len = size_t(1) << position.height;
 
-        size_t offset = rowMajorIndex(
-            (position.index / height_num_cols) * side_len,
-            (position.index % height_num_cols) * side_len,
-            num_cols
-        );
-        size_t start_row = offset / num_cols;
-        size_t start_col = offset % num_cols;
+        size_t start_row = (position.index / height_num_cols) << position.height;
+        size_t start_col = (position.index % height_num_cols) << position.height;
+        size_t offset = rowMajorIndex(start_row, start_col, num_cols);
         size_t actual_num_rows = start_row + side_len > num_rows ? num_rows - start_row : side_len;
         size_t actual_num_cols = start_col + side_len > num_cols ? num_cols - start_col : side_len;
 
@@ -179,23 +325,54 @@ namespace ldg
     }
 
     /**
-     * Get a value at a position in the tree. If it is out-of-bounds, returns nullptr.
+     * Get the index of the parent of a position. This is not safe for the root.
      *
      * @tparam VectorType
      * @param position
      * @return
      */
     template<typename VectorType>
-    std::shared_ptr<VectorType> QuadAssignmentTree<VectorType>::getValue(CellPosition position)
+    size_t QuadAssignmentTree<VectorType>::getParentIndex(CellPosition position) const
+    {
+        return parent_index_cache[bounds_cache[position.height].first.first + position.index];
+    }
+
+    /**
+     * Get the indices of the children of a position. Because the quad tree is build from the bottom up and hence does not
+     * always split up into 4, children that do not exist are -1. This is not safe for leaves.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return Child indices of the node, in the order: [NW, NE, SW, SE].
+     */
+    template<typename VectorType>
+    std::array<long, 4> const &QuadAssignmentTree<VectorType>::getChildrenIndices(CellPosition position) const
+    {
+        return children_index_cache[bounds_cache[position.height].first.first - num_rows * num_cols + position.index];
+    }
+
+    /**
+     * Get a view of the value at a position in the tree. If it is out-of-bounds or void, returns an empty view.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return
+     */
+    template<typename VectorType>
+    VectorView<VectorType> QuadAssignmentTree<VectorType>::getValue(CellPosition position)
     {
         auto bounds = getBounds(position.height);
         auto start_end = bounds.first;
-        size_t index = start_end.first + position.index;
-        return index < start_end.second ? data[assignment[index]] : nullptr;
+        if (start_end.first + position.index >= start_end.second)
+            return nullptr;
+
+        size_t index = start_end.first + getStorageIndex(position);
+        return data.getRow(position.height == 0 ? assignment[index] : index);
     }
 
     /**
-     * Set the value at a given position.
+     * Overwrite the parent value at a given position in place. A void view marks the parent as void.
+     * Leaves can not be set, since they are only moved through the assignment.
      *
      * @tparam VectorType
      * @param position
@@ -203,19 +380,17 @@ namespace ldg
      * @return True if setting the value worked, false if not.
      */
     template<typename VectorType>
-    bool QuadAssignmentTree<VectorType>::setValue(CellPosition position, VectorType *value)
+    bool QuadAssignmentTree<VectorType>::setParentValue(CellPosition position, VectorView<VectorType> value)
     {
         auto bounds = getBounds(position.height);
         auto start_end = bounds.first;
-        size_t index = start_end.first + position.index;
 
-        if (index < start_end.second) {
+        if (position.height > 0 && start_end.first + position.index < start_end.second) {
+            size_t index = start_end.first + getStorageIndex(position);
             if (value == nullptr) {
-                data[assignment[index]] = nullptr;
-            } else if (data[assignment[index]] == nullptr) {
-                data[assignment[index]] = std::make_shared<VectorType>(*value);
+                data.clearRow(index);
             } else {
-                *data[assignment[index]] = std::move(*value);
+                data.setRow(index, *value);
             }
             return true;
         }
@@ -224,7 +399,34 @@ namespace ldg
     }
 
     /**
-     * Get the assignment value at a position in the tree. This is not safe for out of bounds values.
+     * Get a writable map of the parent value at a given position, which is marked as non-void.
+     * This allows parents to be computed in place, after which updateParentNorm() should be called. This is not safe for leaves or out of bounds values.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return
+     */
+    template<typename VectorType>
+    Eigen::Map<VectorType> QuadAssignmentTree<VectorType>::getMutableParentValue(CellPosition position)
+    {
+        return data.getMutableRow(getBounds(position.height).first.first + getStorageIndex(position));
+    }
+
+    /**
+     * Update the cached norm of a parent that was computed in place.
+     *
+     * @tparam VectorType
+     * @param position
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::updateParentNorm(CellPosition position)
+    {
+        data.updateNorm(getBounds(position.height).first.first + getStorageIndex(position));
+    }
+
+    /**
+     * Get the index of the data row at a position in the tree. For leaves this is the assignment value, while parents map to
+     * their own row. This is not safe for out of bounds values.
      *
      * @tparam VectorType
      * @param position
@@ -233,14 +435,12 @@ namespace ldg
     template<typename VectorType>
     size_t QuadAssignmentTree<VectorType>::getAssignmentValue(CellPosition position)
     {
-        auto bounds = getBounds(position.height);
-        auto start_end = bounds.first;
-        size_t index = start_end.first + position.index;
-        return assignment[index];
+        size_t index = getBounds(position.height).first.first + getStorageIndex(position);
+        return position.height == 0 ? assignment[index] : index;
     }
 
     /**
-     * Set the assignment at a given position.
+     * Set the assignment at a given leaf position.
      *
      * @tparam VectorType
      * @param position
@@ -252,8 +452,12 @@ namespace ldg
     {
         auto [start_end, dims] = getBounds(position.height);
 
-        if (size_t index = start_end.first + position.index; index < start_end.second) {
-            assignment[index] = value;
+        if (position.height == 0 && start_end.first + position.index < start_end.second) {
+            size_t &current_value = assignment[getStorageIndex(position)];
+            if (current_value != value) {
+                current_value = value;
+                markParentDirty(position);
+            }
             return true;
         }
 
@@ -261,7 +465,97 @@ namespace ldg
     }
 
     /**
-     * Get the current assignment.
+     * Check if a parent has to be recomputed because its children changed.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return
+     */
+    template<typename VectorType>
+    bool QuadAssignmentTree<VectorType>::isDirty(CellPosition position) const
+    {
+        return all_dirty || std::atomic_ref(const_cast<uint8_t &>(dirty_flags[bounds_cache[position.height].first.first + position.index])).load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Mark the parent of a position as dirty. This is safe to call concurrently.
+     *
+     * @tparam VectorType
+     * @param position
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::markParentDirty(CellPosition position)
+    {
+        if (position.height + 1 >= depth)
+            return;
+
+        size_t parent_index = getParentIndex(position);
+        std::atomic_ref(dirty_flags[bounds_cache[position.height + 1].first.first + parent_index]).store(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Mark all parents as dirty, for example after the assignment was changed directly.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::markAllDirty()
+    {
+        all_dirty = true;
+    }
+
+    /**
+     * Mark a parent as up-to-date, which also records that it was recomputed in the next parent version.
+     *
+     * @tparam VectorType
+     * @param position
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::clearDirty(CellPosition position)
+    {
+        std::atomic_ref(dirty_flags[bounds_cache[position.height].first.first + position.index]).store(0, std::memory_order_relaxed);
+        node_versions[bounds_cache[position.height].first.first + position.index] = parent_version + 1;
+    }
+
+    /**
+     * Mark all parents as up-to-date, which completes the next parent version.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::clearAllDirty()
+    {
+        std::fill(dirty_flags.begin(), dirty_flags.end(), 0);
+        all_dirty = false;
+        ++parent_version;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return The number of times the parents were computed.
+     */
+    template<typename VectorType>
+    uint32_t QuadAssignmentTree<VectorType>::getParentVersion() const
+    {
+        return parent_version;
+    }
+
+    /**
+     * Get the parent version in which a parent was last recomputed. A parent that is newer than a version may have changed since.
+     *
+     * @tparam VectorType
+     * @param position
+     * @return The parent version, or 0 if the parent was never computed.
+     */
+    template<typename VectorType>
+    uint32_t QuadAssignmentTree<VectorType>::getNodeVersion(CellPosition position) const
+    {
+        return node_versions[bounds_cache[position.height].first.first + position.index];
+    }
+
+    /**
+     * Get the current assignment of the leaves in storage order, which resolves the partition table first.
+     * Parents should be marked dirty after changing it directly.
      *
      * @tparam VectorType
      * @return
@@ -269,16 +563,189 @@ namespace ldg
     template<typename VectorType>
     std::vector<size_t> &QuadAssignmentTree<VectorType>::getAssignment()
     {
+        resolvePartitionTable();
         return assignment;
     }
 
+    /**
+     * Get a copy of the current assignment of the leaves in row-major order.
+     *
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    std::vector<size_t> QuadAssignmentTree<VectorType>::getRowMajorAssignment() const
+    {
+        if (layout == LayoutType::ROW_MAJOR && partition_table.isEmpty())
+            return assignment;
+
+        std::vector<size_t> row_major_assignment(assignment.size());
+        for (size_t idx = 0; idx < assignment.size(); ++idx) {
+            row_major_assignment[idx] = assignment[getStorageIndex({ 0, idx })];
+        }
+        return row_major_assignment;
+    }
+
+    /**
+     * Prepare the partition table for exchanging the subtrees of the partitions at a height.
+     * A table of another height is resolved first, while a table of the same height is kept, such that its exchanges accumulate.
+     *
+     * @tparam VectorType
+     * @param height
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::preparePartitionTable(size_t height)
+    {
+        if (partition_table.getHeight() == height)
+            return;
+
+        resolvePartitionTable();
+        auto [num_partition_rows, num_partition_cols] = bounds_cache[height].second;
+        partition_table.reset(height, num_partition_rows, num_partition_cols);
+    }
+
+    /**
+     * @tparam VectorType
+     * @param partition Row-major index of a partition at the height of the partition table.
+     * @return The partition that currently stores the subtree of the partition.
+     */
+    template<typename VectorType>
+    size_t QuadAssignmentTree<VectorType>::getPartitionSource(size_t partition) const
+    {
+        return partition_table.getSource(partition);
+    }
+
+    /**
+     * Store the subtree of a partition at the height of the partition table in a source partition, which moves the subtree in O(1).
+     * The partition itself is marked dirty, such that the parents above it are recomputed. This is safe to call concurrently for
+     * different partitions.
+     *
+     * @tparam VectorType
+     * @param partition Row-major index of a partition at the height of the partition table.
+     * @param source
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::setPartitionSource(size_t partition, size_t source)
+    {
+        partition_table.setSource(partition, source);
+        std::atomic_ref(dirty_flags[bounds_cache[partition_table.getHeight()].first.first + partition]).store(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Move the subtrees to the partitions the partition table redirects them to and remove the table.
+     * The sources form cycles of partitions, each of which is rotated by saving the subtree of its first partition and moving every
+     * other subtree one step along the cycle. This moves the leaves and the parents below the table, so no parent has to be recomputed.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::resolvePartitionTable()
+    {
+        using Scalar = typename VectorType::Scalar;
+        if (partition_table.isEmpty())
+            return;
+
+        PartitionTable table;
+        std::swap(table, partition_table);  // Storage indices are no longer redirected from here on
+        size_t height = table.getHeight();
+        size_t num_partitions = bounds_cache[height].second.first * bounds_cache[height].second.second;
+
+        std::vector<size_t> cycle_starts;
+        std::vector<uint8_t> is_visited(num_partitions, 0);
+        for (size_t partition = 0; partition < num_partitions; ++partition) {
+            if (is_visited[partition] || table.getSource(partition) == partition)
+                continue;
+
+            cycle_starts.push_back(partition);
+            for (size_t member = partition; !is_visited[member]; member = table.getSource(member))
+                is_visited[member] = 1;
+        }
+
+        size_t num_leaves = bounds_cache[0].first.second;
+        std::vector<size_t> target_indices, source_indices, saved_assignment;
+        std::vector<uint8_t> saved_is_void;
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> saved_values;
+
+#pragma omp parallel for private(target_indices, source_indices, saved_assignment, saved_is_void, saved_values) schedule(dynamic)
+        for (size_t idx = 0; idx < cycle_starts.size(); ++idx) {
+            size_t partition = cycle_starts[idx];
+            getSubtreeIndices(height, partition, target_indices);
+
+            saved_assignment.clear();
+            saved_is_void.assign(target_indices.size(), 0);
+            saved_values.resize(static_cast<Eigen::Index>(target_indices.size()), static_cast<Eigen::Index>(getDataElementLen()));
+            for (size_t node = 0; node < target_indices.size(); ++node) {
+                if (target_indices[node] < num_leaves) {
+                    saved_assignment.push_back(assignment[target_indices[node]]);
+                } else if (data.isVoid(target_indices[node])) {
+                    saved_is_void[node] = 1;
+                } else {
+                    saved_values.row(node) = (*data.getRow(target_indices[node])).transpose();
+                }
+            }
+
+            for (size_t source = table.getSource(partition); source != cycle_starts[idx]; source = table.getSource(source)) {
+                getSubtreeIndices(height, source, source_indices);
+                for (size_t node = 0; node < target_indices.size(); ++node) {
+                    if (target_indices[node] < num_leaves) {
+                        assignment[target_indices[node]] = assignment[source_indices[node]];
+                    } else if (data.isVoid(source_indices[node])) {
+                        data.clearRow(target_indices[node]);
+                    } else {
+                        data.setRow(target_indices[node], *data.getRow(source_indices[node]));
+                    }
+                }
+                std::swap(target_indices, source_indices);
+            }
+
+            for (size_t node = 0; node < target_indices.size(); ++node) {
+                if (target_indices[node] < num_leaves) {
+                    assignment[target_indices[node]] = saved_assignment[node];
+                } else if (saved_is_void[node]) {
+                    data.clearRow(target_indices[node]);
+                } else {
+                    data.setRow(target_indices[node], saved_values.row(node).transpose());
+                }
+            }
+        }
+    }
+
+    /**
+     * Get the storage indices of all nodes in the subtree of a partition, from the leaves up to the partition itself.
+     * Leaves index the assignment, while parents index their data row. Partitions of the same shape list their nodes in the same order.
+     *
+     * @tparam VectorType
+     * @param height
+     * @param partition
+     * @param indices   Filled with the storage indices.
+     */
+    template<typename VectorType>
+    void QuadAssignmentTree<VectorType>::getSubtreeIndices(size_t height, size_t partition, std::vector<size_t> &indices) const
+    {
+        size_t partition_row = partition / bounds_cache[height].second.second;
+        size_t partition_col = partition % bounds_cache[height].second.second;
+        indices.clear();
+        for (size_t node_height = 0; node_height <= height; ++node_height) {
+            auto [start_end, dims] = bounds_cache[node_height];
+            size_t shift = height - node_height;
+            size_t min_row = partition_row << shift;
+            size_t min_col = partition_col << shift;
+            size_t max_row = std::min(min_row + (size_t(1) << shift), dims.first);
+            size_t max_col = std::min(min_col + (size_t(1) << shift), dims.second);
+            for (size_t row = min_row; row < max_row; ++row) {
+                for (size_t col = min_col; col < max_col; ++col)
+                    indices.push_back(start_end.first + getLayoutIndex({ node_height, rowMajorIndex(row, col, dims.second) }));
+            }
+        }
+    }
+
     /**
      * Get the current data.
      * @tparam VectorType
      * @return
      */
     template<typename VectorType>
-    std::vector<std::shared_ptr<VectorType>> &QuadAssignmentTree<VectorType>::getData()
+    FeatureMatrix<VectorType> &QuadAssignmentTree<VectorType>::getData()
     {
         return data;
     }
@@ -352,6 +819,16 @@ namespace ldg
     {
         return parent_type;
     }
+
+    /**
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    LayoutType QuadAssignmentTree<VectorType>::getLayout() const
+    {
+        return layout;
+    }
 }
 
 #endif //IMPROVED_LDG_QUAD_ASSIGNMENT_TREE_HPP
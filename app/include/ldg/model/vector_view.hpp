@@ -0,0 +1,163 @@
+#ifndef LDG_CORE_VECTOR_VIEW_HPP
+#define LDG_CORE_VECTOR_VIEW_HPP
+
+#include <cstddef>
+#include <Eigen/Core>
+
+namespace ldg
+{
+    /**
+     * Lightweight, non-owning view of a single data vector. Behaves like a nullable pointer: void cells are represented by
+     * a view that compares equal to nullptr, and dereferencing gives an Eigen map over the underlying memory.
+     * Views of stored rows also carry the cached L2 norm of the row, such that it does not have to be recomputed.
+     * Copying a view is free, so it should be passed by value.
+     *
+     * @tparam VectorType The (Eigen) vector type the view represents.
+     */
+    template<typename VectorType>
+    class VectorView
+    {
+        using Scalar = typename VectorType::Scalar;
+
+        const Scalar *data_ptr;
+        Eigen::Index num_elements;
+        double norm;    // Negative if unknown.
+
+    public:
+        using MapType = Eigen::Map<const VectorType>;
+
+        VectorView(std::nullptr_t = nullptr);
+
+        VectorView(const Scalar *data_ptr, Eigen::Index num_elements, double norm = -1.);
+
+        explicit VectorView(const VectorType *vector);
+
+        MapType operator*() const;
+
+        const Scalar *data() const;
+
+        Eigen::Index size() const;
+
+        bool hasNorm() const;
+
+        double getNorm() const;
+
+        bool operator==(std::nullptr_t) const;
+
+        explicit operator bool() const;
+    };
+
+    /**
+     * Create an empty (void) view.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    VectorView<VectorType>::VectorView(std::nullptr_t):
+        data_ptr(nullptr),
+        num_elements(0),
+        norm(-1.)
+    {}
+
+    /**
+     * Create a view over raw memory.
+     *
+     * @tparam VectorType
+     * @param data_ptr
+     * @param num_elements
+     * @param norm The L2 norm of the vector if it is known, negative otherwise.
+     */
+    template<typename VectorType>
+    VectorView<VectorType>::VectorView(const Scalar *data_ptr, Eigen::Index num_elements, double norm):
+        data_ptr(data_ptr),
+        num_elements(num_elements),
+        norm(norm)
+    {}
+
+    /**
+     * Create a view over an existing vector. A nullptr results in an empty view.
+     *
+     * @tparam VectorType
+     * @param vector
+     */
+    template<typename VectorType>
+    VectorView<VectorType>::VectorView(const VectorType *vector):
+        data_ptr(vector == nullptr ? nullptr : vector->data()),
+        num_elements(vector == nullptr ? 0 : vector->size()),
+        norm(-1.)
+    {}
+
+    /**
+     * Map the view to an Eigen vector expression. Only valid for non-empty views.
+     *
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    typename VectorView<VectorType>::MapType VectorView<VectorType>::operator*() const
+    {
+        return MapType(data_ptr, num_elements);
+    }
+
+    /**
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    const typename VectorView<VectorType>::Scalar *VectorView<VectorType>::data() const
+    {
+        return data_ptr;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return
+     */
+    template<typename VectorType>
+    Eigen::Index VectorView<VectorType>::size() const
+    {
+        return num_elements;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return True if the L2 norm of the vector is cached in the view.
+     */
+    template<typename VectorType>
+    bool VectorView<VectorType>::hasNorm() const
+    {
+        return norm >= 0.;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return The cached L2 norm of the vector. Only valid if hasNorm() is true.
+     */
+    template<typename VectorType>
+    double VectorView<VectorType>::getNorm() const
+    {
+        return norm;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return True if the view does not point to any data.
+     */
+    template<typename VectorType>
+    bool VectorView<VectorType>::operator==(std::nullptr_t) const
+    {
+        return data_ptr == nullptr;
+    }
+
+    /**
+     * @tparam VectorType
+     * @return True if the view points to data.
+     */
+    template<typename VectorType>
+    VectorView<VectorType>::operator bool() const
+    {
+        return data_ptr != nullptr;
+    }
+}
+
+#endif //LDG_CORE_VECTOR_VIEW_HPP
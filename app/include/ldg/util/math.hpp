@@ -1,9 +1,18 @@
 #ifndef LDG_CORE_MATH_HPP
 #define LDG_CORE_MATH_HPP
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <cmath>
+#include <functional>
 #include <Eigen/Dense>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+#include "app/include/ldg/model/vector_view.hpp"
+#include "app/include/ldg/util/metric/kernels.hpp"
 
 namespace ldg
 {
@@ -19,51 +28,227 @@ namespace ldg
     }
 
     /**
-     * Simple shorthand to divide by a factor and round up.
+     * Divide by a power of two and round up. Only uses integer arithmetic, so it is exact for any size.
      *
      * @param num
-     * @param factor
+     * @param power
      * @return
      */
-    inline size_t ceilDivideByFactor(size_t num, float factor)
+    inline size_t ceilDivideByPowerTwo(size_t num, size_t power)
     {
-        return static_cast<size_t>(std::ceil(static_cast<float>(num) / factor));
+        return (num + (size_t(1) << power) - 1) >> power;
     }
 
     /**
-     * Simple shorthand to divide by two and round up.
+     * Spread the lower 32 bits of a number over the even bits, such that two spread numbers can be interleaved.
      *
-     * @param num
-     * @param power
+     * @param value
      * @return
      */
-    inline size_t ceilDivideByPowerTwo(size_t num, size_t power)
+    inline uint64_t spreadBits(uint64_t value)
+    {
+#ifdef __BMI2__
+        return _pdep_u64(value, 0x5555555555555555ull);
+#else
+        value &= 0x00000000FFFFFFFFull;
+        value = (value | (value << 16)) & 0x0000FFFF0000FFFFull;
+        value = (value | (value << 8)) & 0x00FF00FF00FF00FFull;
+        value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        value = (value | (value << 2)) & 0x3333333333333333ull;
+        return (value | (value << 1)) & 0x5555555555555555ull;
+#endif
+    }
+
+    /**
+     * Gather the even bits of a number into its lower 32 bits. This is the inverse of spreadBits.
+     *
+     * @param value
+     * @return
+     */
+    inline uint64_t compactBits(uint64_t value)
+    {
+#ifdef __BMI2__
+        return _pext_u64(value, 0x5555555555555555ull);
+#else
+        value &= 0x5555555555555555ull;
+        value = (value | (value >> 1)) & 0x3333333333333333ull;
+        value = (value | (value >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+        value = (value | (value >> 4)) & 0x00FF00FF00FF00FFull;
+        value = (value | (value >> 8)) & 0x0000FFFF0000FFFFull;
+        return (value | (value >> 16)) & 0x00000000FFFFFFFFull;
+#endif
+    }
+
+    /**
+     * Get the Z-order (Morton) index of a cell by interleaving the bits of its coordinates, with the column in the lowest bit.
+     *
+     * @param row
+     * @param col
+     * @return
+     */
+    inline size_t mortonIndex(size_t row, size_t col)
     {
-        return ceilDivideByFactor(num, std::pow(2., power));
+        return spreadBits(col) | (spreadBits(row) << 1);
+    }
+
+    /**
+     * Get the cell of a Z-order (Morton) index.
+     *
+     * @param index
+     * @return [row, column]
+     */
+    inline std::pair<size_t, size_t> mortonPosition(size_t index)
+    {
+        return { compactBits(index >> 1), compactBits(index) };
     }
 
     /**
      * Aggregate multiple vectors into one, ignoring null pointers and dividing by the number of elements.
+     * The sum is kept in the accumulator type of the data, such that integer data does not overflow. Integer averages are rounded.
      *
      * @tparam VectorType
      * @param vectors
      * @param vector_num_elements
+     * @param rows  Scratch buffer for the data of the non-void vectors, which can be reused between calls to avoid allocations.
      * @return
      */
     template<typename VectorType>
-    VectorType aggregate(std::vector<std::shared_ptr<VectorType>> &vectors, size_t vector_num_elements)
-    {
+    VectorType aggregate(
+        std::vector<VectorView<VectorType>> &vectors,
+        size_t vector_num_elements,
+        std::vector<const typename VectorType::Scalar *> &rows
+    ) {
+        using Scalar = typename VectorType::Scalar;
+        using AccumulatorType = typename Accumulator<Scalar>::Type;
+        using AccumulatorVector = Eigen::Matrix<AccumulatorType, VectorType::RowsAtCompileTime, 1>;
+
+        if constexpr (std::is_floating_point_v<Scalar> && simd::supportsKernels<Eigen::Map<const VectorType>>()) {
+            if (simd::getInstructionSet() != simd::SCALAR) {
+                rows.clear();
+                for (auto vector_ptr : vectors) {
+                    if (vector_ptr != nullptr)
+                        rows.push_back(vector_ptr.data());
+                }
+                VectorType result(vector_num_elements);
+                simd::averageRows(rows.data(), rows.size(), result.data(), vector_num_elements);
+                return result;
+            }
+        }
+
         double count = 0.;
-        VectorType aggregate = VectorType::Zero(vector_num_elements);
+        AccumulatorVector aggregate = AccumulatorVector::Zero(vector_num_elements);
 
         for (auto vector_ptr : vectors) {
             if (vector_ptr != nullptr) {
-                aggregate += *vector_ptr;
+                aggregate += (*vector_ptr).template cast<AccumulatorType>();
                 ++count;
             }
         }
 
-        return aggregate / std::max(1., count);
+        auto divisor = static_cast<AccumulatorType>(std::max(1., count));
+        if constexpr (std::is_integral_v<Scalar>) {
+            return ((aggregate.array() + divisor / 2) / divisor).matrix().template cast<Scalar>();
+        } else {
+            return aggregate / divisor;
+        }
+    }
+
+    /**
+     * Aggregate a fixed number of vectors into an existing vector, ignoring null pointers and dividing by the number of elements.
+     * This allows parents to be aggregated in place without allocating.
+     *
+     * @tparam VectorType
+     * @tparam NumVectors
+     * @param vectors
+     * @param result
+     */
+    template<typename VectorType, size_t NumVectors>
+    void aggregate(std::array<VectorView<VectorType>, NumVectors> const &vectors, Eigen::Map<VectorType> result)
+    {
+        using Scalar = typename VectorType::Scalar;
+
+        if constexpr (std::is_integral_v<Scalar>) {
+            // Sum per element in the wider accumulator type and round, which avoids a temporary accumulator vector.
+            using AccumulatorType = typename Accumulator<Scalar>::Type;
+            std::array<const Scalar *, NumVectors> vector_data;
+            AccumulatorType count = 0;
+            for (auto vector_ptr : vectors) {
+                if (vector_ptr != nullptr)
+                    vector_data[count++] = vector_ptr.data();
+            }
+            AccumulatorType divisor = std::max<AccumulatorType>(1, count);
+
+            for (Eigen::Index idx = 0; idx < result.size(); ++idx) {
+                AccumulatorType sum = 0;
+                for (AccumulatorType vector_idx = 0; vector_idx < count; ++vector_idx)
+                    sum += vector_data[vector_idx][idx];
+                result(idx) = static_cast<Scalar>((sum + divisor / 2) / divisor);
+            }
+        } else {
+            if constexpr (simd::supportsKernels<Eigen::Map<VectorType>>()) {
+                if (simd::getInstructionSet() != simd::SCALAR) {
+                    std::array<const Scalar *, NumVectors> vector_data;
+                    size_t count = 0;
+                    for (auto vector_ptr : vectors) {
+                        if (vector_ptr != nullptr)
+                            vector_data[count++] = vector_ptr.data();
+                    }
+                    simd::averageRows(vector_data.data(), count, result.data(), size_t(result.size()));
+                    return;
+                }
+            }
+
+            double count = 0.;
+            result.setZero();
+
+            for (auto vector_ptr : vectors) {
+                if (vector_ptr != nullptr) {
+                    result += *vector_ptr;
+                    ++count;
+                }
+            }
+
+            result /= static_cast<Scalar>(std::max(1., count));
+        }
+    }
+
+    /**
+     * Find the index of the value with the minimum distance to all other values for a fixed number of vectors.
+     * Assumes a symmetric distance function and at least one non-null vector.
+     *
+     * @tparam VectorType
+     * @tparam NumVectors
+     * @tparam DistanceFunction
+     * @param vectors
+     * @param distance_function
+     * @return
+     */
+    template<typename VectorType, size_t NumVectors, typename DistanceFunction>
+    size_t findMinimumIndex(
+        std::array<VectorView<VectorType>, NumVectors> const &vectors,
+        DistanceFunction const &distance_function
+    ) {
+        double min_distance = std::numeric_limits<double>::max();
+        size_t result = 0;
+        std::array<double, NumVectors> distances{};
+        for (size_t idx = 0; idx < NumVectors; ++idx) {
+            if (vectors[idx] == nullptr)
+                continue;
+
+            for (size_t compare_idx = idx + 1; compare_idx < NumVectors; ++compare_idx) {
+                double distance = distance_function(vectors[idx], vectors[compare_idx]);
+                distances[idx] += distance;
+                distances[compare_idx] += distance;
+            }
+
+            // Check if total distance is smaller and accept if it is
+            if (min_distance > distances[idx]) {
+                result = idx;
+                min_distance = distances[idx];
+            }
+        }
+
+        return result;
     }
 
     /**
@@ -71,18 +256,21 @@ namespace ldg
      * Assumes a symmetric distance function.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param vectors
      * @param distance_function
+     * @param distances Scratch buffer for the summed distances, which can be reused between calls to avoid allocations.
      * @return
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     VectorType findMinimum(
-        std::vector<std::shared_ptr<VectorType>> &vectors,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function
+        std::vector<VectorView<VectorType>> &vectors,
+        DistanceFunction distance_function,
+        std::vector<double> &distances
     ) {
         double min_distance = std::numeric_limits<double>::max();
         VectorType result;
-        std::vector<double> distances(vectors.size(), 0.);
+        distances.assign(vectors.size(), 0.);
         for (size_t idx = 0; idx < vectors.size(); ++idx) {
             if (vectors[idx] == nullptr)
                 continue;
@@ -103,9 +291,27 @@ namespace ldg
         return result;
     }
 
+    /**
+     * Find the value with the minimum distance to all other vectors.
+     * Assumes a symmetric distance function.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param vectors
+     * @param distance_function
+     * @return
+     */
+    template<typename VectorType, typename DistanceFunction>
+    VectorType findMinimum(
+        std::vector<VectorView<VectorType>> &vectors,
+        DistanceFunction distance_function
+    ) {
+        std::vector<double> distances;
+        return findMinimum(vectors, distance_function, distances);
+    }
+
     /**
      * Aggregate multiple vectors into one, ignoring null pointers and dividing by the number of elements.
-     * Note that we assume that the default constructor of the template type initializes to 0.
      *
      * @tparam VectorType
      * @param vectors
@@ -113,19 +319,25 @@ namespace ldg
      * @return
      */
     template<typename VectorType>
-    VectorType aggregate(std::vector<std::shared_ptr<VectorType>> &&vectors, size_t num_elements)
+    VectorType aggregate(std::vector<VectorView<VectorType>> &vectors, size_t num_elements)
     {
-        double count = 0.;
-        VectorType aggregate = VectorType::Zero(num_elements);
-
-        for (auto vector_ptr : vectors) {
-            if (vector_ptr != nullptr) {
-                aggregate += *vector_ptr;
-                ++count;
-            }
-        }
+        std::vector<const typename VectorType::Scalar *> rows;
+        return aggregate(vectors, num_elements, rows);
+    }
 
-        return aggregate / std::max(1., count);
+    /**
+     * Aggregate multiple vectors into one, ignoring null pointers and dividing by the number of elements.
+     * Note that we assume that the default constructor of the template type initializes to 0.
+     *
+     * @tparam VectorType
+     * @param vectors
+     * @param num_elements
+     * @return
+     */
+    template<typename VectorType>
+    VectorType aggregate(std::vector<VectorView<VectorType>> &&vectors, size_t num_elements)
+    {
+        return aggregate(vectors, num_elements);
     }
 }
 
@@ -0,0 +1,46 @@
+#ifndef CHEBYSHEV_DISTANCE_HPP
+#define CHEBYSHEV_DISTANCE_HPP
+
+#include "app/include/ldg/model/vector_view.hpp"
+#include "kernels.hpp"
+
+namespace ldg
+{
+    /**
+     * Take the chebyshev (L-infinity) distance between two data items, which is the largest difference of any element.
+     *
+     * @tparam VectorType
+     * @param lhs
+     * @param rhs
+     * @param bound The computation may be abandoned once the distance is known to exceed this bound.
+     * @return 0 if the items are equal or if one of the items is nullptr. Infinity if the computation was abandoned.
+     */
+    template<typename VectorType>
+    double chebyshevDistance(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        if (lhs == nullptr || rhs == nullptr)
+            return 0.;
+
+        return maximumDistance(*lhs, *rhs, bound);
+    }
+
+    /**
+     * Functor of the chebyshev distance, such that it can be inlined into the algorithms it is passed to.
+     */
+    struct ChebyshevDistance
+    {
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs) const
+        {
+            return chebyshevDistance(lhs, rhs);
+        }
+
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound) const
+        {
+            return chebyshevDistance(lhs, rhs, bound);
+        }
+    };
+}
+
+#endif //CHEBYSHEV_DISTANCE_HPP
@@ -1,12 +1,13 @@
 #ifndef COSINE_DISTANCE_HPP
 #define COSINE_DISTANCE_HPP
 
-#include <memory>
+#include "app/include/ldg/model/vector_view.hpp"
+#include "kernels.hpp"
 
 namespace ldg
 {
     /**
-     * Take the cosine distance between two items.
+     * Take the cosine distance between two items. Cached norms of the items are used if available, such that only the dot product is computed.
      *
      * @tparam VectorType
      * @param lhs
@@ -14,14 +15,42 @@ namespace ldg
      * @return 0 if the items are equal or if one of the items is nullptr.
      */
     template<typename VectorType>
-    double cosineDistance(std::shared_ptr<VectorType> const &lhs, std::shared_ptr<VectorType> const &rhs)
+    double cosineDistance(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs)
     {
         if (lhs == nullptr || rhs == nullptr)
             return 0.;
 
-        double norm = (*lhs).norm() * (*rhs).norm();
-        return norm == 0. ? 0. : 1. - (*lhs).dot(*rhs) / norm;  // Completely empty vectors are likely aggregates of void cells, so set to 0
+        double norm_product = (lhs.hasNorm() ? lhs.getNorm() : norm(*lhs)) * (rhs.hasNorm() ? rhs.getNorm() : norm(*rhs));
+        return norm_product == 0. ? 0. : 1. - dotProduct(*lhs, *rhs) / norm_product;  // Completely empty vectors are likely aggregates of void cells, so set to 0
     }
+
+    /**
+     * Functor of the cosine distance, such that it can be inlined into the algorithms it is passed to.
+     */
+    struct CosineDistance
+    {
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs) const
+        {
+            return cosineDistance(lhs, rhs);
+        }
+
+        /**
+         * Compute the distance from a dot product and the norms of both items.
+         * This allows computing many distances at once as a matrix product.
+         *
+         * @param dot_product
+         * @param lhs_norm
+         * @param rhs_norm
+         * @param num_elements Unused.
+         * @return
+         */
+        static double fromDotProduct(double dot_product, double lhs_norm, double rhs_norm, size_t)
+        {
+            double norm_product = lhs_norm * rhs_norm;
+            return norm_product == 0. ? 0. : 1. - dot_product / norm_product;
+        }
+    };
 }
 
 #endif //COSINE_DISTANCE_HPP
@@ -8,21 +8,22 @@
 
 namespace ldg
 {
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     inline std::vector<double> computeDisparity(
         QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function
+        DistanceFunction distance_function
     )
     {
         size_t num_leafs = quad_tree.getNumRows() * quad_tree.getNumCols();
-        size_t num_nodes = quad_tree.getAssignment().size();
+        size_t num_nodes = quad_tree.getData().size();
         auto disparities = std::vector<double>(num_nodes, 0.);
 
         for (size_t idx = 0; idx < num_leafs; ++idx) {
             auto leaf_value = quad_tree.getValue({ 0, idx });
             TreeWalker walker{ { 0, idx }, quad_tree };
             while (walker.moveUp()) {
-                disparities[quad_tree.getAssignmentValue(walker.getNode())] += distance_function(leaf_value, walker.getNodeValue());
+                auto node = walker.getNode();
+                disparities[quad_tree.getBounds(node.height).first.first + node.index] += distance_function(leaf_value, walker.getNodeValue());
             }
         }
 
@@ -3,10 +3,13 @@
 
 #include "cosine_distance.hpp"
 #include "normalized_euclidean_distance.hpp"
+#include "squared_euclidean_distance.hpp"
+#include "manhattan_distance.hpp"
+#include "chebyshev_distance.hpp"
 
-#include <cassert>
-#include <functional>
-#include <memory>
+#include <concepts>
+#include <stdexcept>
+#include "app/include/ldg/model/vector_view.hpp"
 
 namespace ldg
 {
@@ -16,26 +19,65 @@ namespace ldg
     enum DistanceFunctionType
     {
         EUCLIDEAN_DISTANCE,
-        COSINE_SIMILARITY
+        COSINE_SIMILARITY,
+        SQUARED_EUCLIDEAN_DISTANCE,
+        MANHATTAN_DISTANCE,
+        CHEBYSHEV_DISTANCE
     };
 
     /**
-     * Map the distance function type to its actual function.
+     * Distance functions that can be computed from a dot product and the norms of both items, such that the distances
+     * between many items can be computed at once as a matrix product.
      *
+     * @tparam DistanceFunction
+     */
+    template<typename DistanceFunction>
+    concept DotProductDistance = requires(double value, size_t num_elements) {
+        { DistanceFunction::fromDotProduct(value, value, value, num_elements) } -> std::convertible_to<double>;
+    };
+
+    /**
+     * Distance functions that accept an upper bound, such that the computation can be abandoned once the distance is known to
+     * exceed it. Abandoned computations return infinity.
+     *
+     * @tparam DistanceFunction
      * @tparam VectorType
+     */
+    template<typename DistanceFunction, typename VectorType>
+    concept BoundedDistance = requires(DistanceFunction const &distance_function, VectorView<VectorType> const &view, double bound) {
+        { distance_function(view, view, bound) } -> std::convertible_to<double>;
+    };
+
+    /**
+     * Map the distance function type to its functor and call the callback with it.
+     * The functor type is a template parameter of everything that computes distances, so this is the only place where the
+     * distance function is selected at runtime.
+     *
+     * @tparam Callback
      * @param type
-     * @return
+     * @param callback Generic callable that accepts any of the distance functors.
      */
-    template<typename VectorType>
-    std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> mapFunctionTypeToFunction(DistanceFunctionType type)
+    template<typename Callback>
+    void withDistanceFunction(DistanceFunctionType type, Callback &&callback)
     {
         switch (type) {
             case EUCLIDEAN_DISTANCE:
-                return normalizedEuclideanDistance<VectorType>;
+                callback(NormalizedEuclideanDistance{});
+                break;
             case COSINE_SIMILARITY:
-                return cosineDistance<VectorType>;
+                callback(CosineDistance{});
+                break;
+            case SQUARED_EUCLIDEAN_DISTANCE:
+                callback(SquaredEuclideanDistance{});
+                break;
+            case MANHATTAN_DISTANCE:
+                callback(ManhattanDistance{});
+                break;
+            case CHEBYSHEV_DISTANCE:
+                callback(ChebyshevDistance{});
+                break;
             default:
-                assert(false);  // Should never happen
+                throw std::invalid_argument("Unsupported distance function");
         }
     }
 }
@@ -12,15 +12,16 @@ namespace ldg
      * Compute the HND for a quad tree at a given height.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param height
      * @param distance_function
      * @param quad_tree
      * @return
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     double computeHierarchyNeighborhoodDistance(
         size_t height,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
         QuadAssignmentTree<VectorType> &quad_tree
     )
     {
@@ -87,6 +88,7 @@ namespace ldg
      * Compute the distance to the upper hierarchy members at a certain position.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param position
      * @param value
      * @param distance_function
@@ -94,11 +96,11 @@ namespace ldg
      * @param cache Cache of already computed distances between value and parents.
      * @return
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     double computeHierarchyDistanceForCell(
         CellPosition position,
-        std::shared_ptr<VectorType> &value,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        VectorView<VectorType> value,
+        DistanceFunction distance_function,
         QuadAssignmentTree<VectorType> &quad_tree,
         std::map<std::pair<size_t, size_t>, double> &cache
     )
@@ -0,0 +1,207 @@
+#ifndef LDG_CORE_KERNELS_HPP
+#define LDG_CORE_KERNELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <Eigen/Core>
+#include "simd_kernels.hpp"
+
+namespace ldg
+{
+    /**
+     * Accumulator type used when summing over the elements of a data vector.
+     * Floating point data is accumulated in its own type, while integer data is widened to avoid overflows.
+     *
+     * @tparam Scalar
+     */
+    template<typename Scalar>
+    struct Accumulator
+    {
+        using Type = Scalar;
+        static constexpr Eigen::Index BLOCK_LEN = std::numeric_limits<Eigen::Index>::max(); // Max number of elements per partial sum.
+    };
+
+    /**
+     * Bytes are accumulated in 32-bit integers. Sums of squares are split up in blocks of 2^15 elements, since 255^2 * 2^15 < 2^31.
+     */
+    template<>
+    struct Accumulator<uint8_t>
+    {
+        using Type = int32_t;
+        static constexpr Eigen::Index BLOCK_LEN = 1 << 15;
+    };
+
+    /**
+     * Shorts are accumulated in 64-bit integers, since a single squared difference might not fit in a 32-bit integer.
+     */
+    template<>
+    struct Accumulator<uint16_t>
+    {
+        using Type = int64_t;
+        static constexpr Eigen::Index BLOCK_LEN = std::numeric_limits<Eigen::Index>::max();
+    };
+
+    /**
+     * Compute the sum of squared differences (SSD) between two vectors.
+     * Contiguous vectors use the explicit SIMD kernels if the CPU supports them.
+     * Otherwise, integer vectors are widened per block before subtracting, such that the integer SIMD units can be used without overflows.
+     * The computation may stop early once the partial sum exceeds the bound, which is done by the SIMD kernels and per integer block.
+     *
+     * @tparam LhsDerived
+     * @tparam RhsDerived
+     * @param lhs
+     * @param rhs
+     * @param bound
+     * @return The SSD, or simd::ABANDONED if the bound was exceeded.
+     */
+    template<typename LhsDerived, typename RhsDerived>
+    double squaredDistance(Eigen::MatrixBase<LhsDerived> const &lhs, Eigen::MatrixBase<RhsDerived> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        using Scalar = typename LhsDerived::Scalar;
+        if constexpr (simd::supportsKernels<LhsDerived>() && simd::supportsKernels<RhsDerived>()) {
+            if (simd::getInstructionSet() != simd::SCALAR)
+                return simd::squaredDistance(lhs.derived().data(), rhs.derived().data(), size_t(lhs.size()), bound);
+        }
+
+        if constexpr (std::is_floating_point_v<Scalar>) {
+            return (lhs - rhs).squaredNorm();
+        } else {
+            using AccumulatorType = typename Accumulator<Scalar>::Type;
+            constexpr Eigen::Index block_len = Accumulator<Scalar>::BLOCK_LEN;
+
+            int64_t sum = 0;
+            for (Eigen::Index start = 0; start < lhs.size(); start += block_len) {
+                Eigen::Index len = std::min(block_len, lhs.size() - start);
+                sum += (lhs.segment(start, len).template cast<AccumulatorType>() - rhs.segment(start, len).template cast<AccumulatorType>()).squaredNorm();
+                if (sum > bound)
+                    return simd::ABANDONED;
+            }
+            return static_cast<double>(sum);
+        }
+    }
+
+    /**
+     * Compute the sum of absolute differences (SAD) between two vectors, using the explicit SIMD kernels if possible and widening
+     * integer vectors per block otherwise. Like squaredDistance(), the computation may stop early once the bound is exceeded.
+     *
+     * @tparam LhsDerived
+     * @tparam RhsDerived
+     * @param lhs
+     * @param rhs
+     * @param bound
+     * @return The SAD, or simd::ABANDONED if the bound was exceeded.
+     */
+    template<typename LhsDerived, typename RhsDerived>
+    double absoluteDistance(Eigen::MatrixBase<LhsDerived> const &lhs, Eigen::MatrixBase<RhsDerived> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        using Scalar = typename LhsDerived::Scalar;
+        if constexpr (simd::supportsKernels<LhsDerived>() && simd::supportsKernels<RhsDerived>()) {
+            if (simd::getInstructionSet() != simd::SCALAR)
+                return simd::absoluteDistance(lhs.derived().data(), rhs.derived().data(), size_t(lhs.size()), bound);
+        }
+
+        if constexpr (std::is_floating_point_v<Scalar>) {
+            return (lhs - rhs).template lpNorm<1>();
+        } else {
+            using AccumulatorType = typename Accumulator<Scalar>::Type;
+            constexpr Eigen::Index block_len = Accumulator<Scalar>::BLOCK_LEN;
+
+            int64_t sum = 0;
+            for (Eigen::Index start = 0; start < lhs.size(); start += block_len) {
+                Eigen::Index len = std::min(block_len, lhs.size() - start);
+                sum += (lhs.segment(start, len).template cast<AccumulatorType>() - rhs.segment(start, len).template cast<AccumulatorType>()).cwiseAbs().sum();
+                if (sum > bound)
+                    return simd::ABANDONED;
+            }
+            return static_cast<double>(sum);
+        }
+    }
+
+    /**
+     * Compute the maximum absolute difference between two vectors, using the explicit SIMD kernels if possible.
+     * Integer vectors are widened before subtracting. Only the SIMD kernels stop early once the bound is exceeded.
+     *
+     * @tparam LhsDerived
+     * @tparam RhsDerived
+     * @param lhs
+     * @param rhs
+     * @param bound
+     * @return The maximum absolute difference, or simd::ABANDONED if the bound was exceeded.
+     */
+    template<typename LhsDerived, typename RhsDerived>
+    double maximumDistance(Eigen::MatrixBase<LhsDerived> const &lhs, Eigen::MatrixBase<RhsDerived> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        using Scalar = typename LhsDerived::Scalar;
+        if constexpr (simd::supportsKernels<LhsDerived>() && simd::supportsKernels<RhsDerived>()) {
+            if (simd::getInstructionSet() != simd::SCALAR)
+                return simd::maximumDistance(lhs.derived().data(), rhs.derived().data(), size_t(lhs.size()), bound);
+        }
+
+        if constexpr (std::is_floating_point_v<Scalar>) {
+            return (lhs - rhs).template lpNorm<Eigen::Infinity>();
+        } else {
+            using AccumulatorType = typename Accumulator<Scalar>::Type;
+            return static_cast<double>((lhs.template cast<AccumulatorType>() - rhs.template cast<AccumulatorType>()).template lpNorm<Eigen::Infinity>());
+        }
+    }
+
+    /**
+     * Compute the dot product between two vectors, using the explicit SIMD kernels if possible and widening integer vectors per block otherwise.
+     *
+     * @tparam LhsDerived
+     * @tparam RhsDerived
+     * @param lhs
+     * @param rhs
+     * @return
+     */
+    template<typename LhsDerived, typename RhsDerived>
+    double dotProduct(Eigen::MatrixBase<LhsDerived> const &lhs, Eigen::MatrixBase<RhsDerived> const &rhs)
+    {
+        using Scalar = typename LhsDerived::Scalar;
+        if constexpr (simd::supportsKernels<LhsDerived>() && simd::supportsKernels<RhsDerived>()) {
+            if (simd::getInstructionSet() != simd::SCALAR)
+                return simd::dotProduct(lhs.derived().data(), rhs.derived().data(), size_t(lhs.size()));
+        }
+
+        if constexpr (std::is_floating_point_v<Scalar>) {
+            return lhs.dot(rhs);
+        } else {
+            using AccumulatorType = typename Accumulator<Scalar>::Type;
+            constexpr Eigen::Index block_len = Accumulator<Scalar>::BLOCK_LEN;
+
+            int64_t sum = 0;
+            for (Eigen::Index start = 0; start < lhs.size(); start += block_len) {
+                Eigen::Index len = std::min(block_len, lhs.size() - start);
+                sum += lhs.segment(start, len).template cast<AccumulatorType>().dot(rhs.segment(start, len).template cast<AccumulatorType>());
+            }
+            return static_cast<double>(sum);
+        }
+    }
+
+    /**
+     * Compute the L2 norm of a vector, using the explicit SIMD kernels if possible and widening integer vectors per block otherwise.
+     *
+     * @tparam Derived
+     * @param vector
+     * @return
+     */
+    template<typename Derived>
+    double norm(Eigen::MatrixBase<Derived> const &vector)
+    {
+        if constexpr (simd::supportsKernels<Derived>()) {
+            if (simd::getInstructionSet() != simd::SCALAR)
+                return std::sqrt(simd::dotProduct(vector.derived().data(), vector.derived().data(), size_t(vector.size())));
+        }
+
+        if constexpr (std::is_floating_point_v<typename Derived::Scalar>) {
+            return vector.norm();
+        } else {
+            return std::sqrt(dotProduct(vector, vector));
+        }
+    }
+}
+
+#endif //LDG_CORE_KERNELS_HPP
@@ -0,0 +1,47 @@
+#ifndef MANHATTAN_DISTANCE_HPP
+#define MANHATTAN_DISTANCE_HPP
+
+#include "app/include/ldg/model/vector_view.hpp"
+#include "kernels.hpp"
+
+namespace ldg
+{
+    /**
+     * Take the vector-length normalized manhattan (L1) distance between two data items.
+     *
+     * @tparam VectorType
+     * @param lhs
+     * @param rhs
+     * @param bound The computation may be abandoned once the distance is known to exceed this bound.
+     * @return 0 if the items are equal or if one of the items is nullptr. Infinity if the computation was abandoned.
+     */
+    template<typename VectorType>
+    double manhattanDistance(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        if (lhs == nullptr || rhs == nullptr)
+            return 0.;
+
+        auto num_elements = static_cast<double>((*lhs).size());
+        return absoluteDistance(*lhs, *rhs, bound * num_elements) / num_elements;
+    }
+
+    /**
+     * Functor of the manhattan distance, such that it can be inlined into the algorithms it is passed to.
+     */
+    struct ManhattanDistance
+    {
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs) const
+        {
+            return manhattanDistance(lhs, rhs);
+        }
+
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound) const
+        {
+            return manhattanDistance(lhs, rhs, bound);
+        }
+    };
+}
+
+#endif //MANHATTAN_DISTANCE_HPP
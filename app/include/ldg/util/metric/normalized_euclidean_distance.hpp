@@ -1,7 +1,8 @@
 #ifndef EUCLIDEAN_DISTANCE_HPP
 #define EUCLIDEAN_DISTANCE_HPP
 
-#include <memory>
+#include "app/include/ldg/model/vector_view.hpp"
+#include "kernels.hpp"
 
 namespace ldg
 {
@@ -11,17 +12,53 @@ namespace ldg
      * @tparam VectorType
      * @param lhs
      * @param rhs
-     * @return 0 if the items are equal or if one of the items is nullptr.
+     * @param bound The computation may be abandoned once the distance is known to exceed this bound.
+     * @return 0 if the items are equal or if one of the items is nullptr. Infinity if the computation was abandoned.
      */
     template<typename VectorType>
-    double normalizedEuclideanDistance(std::shared_ptr<VectorType> const &lhs, std::shared_ptr<VectorType> const &rhs)
+    double normalizedEuclideanDistance(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound = std::numeric_limits<double>::infinity())
     {
         if (lhs == nullptr || rhs == nullptr)
             return 0.;
 
 //        return (*lhs - *rhs).norm() / std::sqrt((*lhs).size());
-        return std::sqrt((*lhs - *rhs).squaredNorm() / static_cast<double>((*lhs).size()));
+        auto num_elements = static_cast<double>((*lhs).size());
+        return std::sqrt(squaredDistance(*lhs, *rhs, bound * bound * num_elements) / num_elements);
     }
+
+    /**
+     * Functor of the normalized euclidean distance, such that it can be inlined into the algorithms it is passed to.
+     */
+    struct NormalizedEuclideanDistance
+    {
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs) const
+        {
+            return normalizedEuclideanDistance(lhs, rhs);
+        }
+
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound) const
+        {
+            return normalizedEuclideanDistance(lhs, rhs, bound);
+        }
+
+        /**
+         * Compute the distance from a dot product and the norms of both items, using ||a - b||^2 = ||a||^2 + ||b||^2 - 2a.b.
+         * This allows computing many distances at once as a matrix product.
+         *
+         * @param dot_product
+         * @param lhs_norm
+         * @param rhs_norm
+         * @param num_elements
+         * @return
+         */
+        static double fromDotProduct(double dot_product, double lhs_norm, double rhs_norm, size_t num_elements)
+        {
+            double squared_distance = lhs_norm * lhs_norm + rhs_norm * rhs_norm - 2. * dot_product;
+            return std::sqrt(std::max(squared_distance, 0.) / static_cast<double>(num_elements));  // Clamp rounding errors of nearly equal items
+        }
+    };
 }
 
 #endif //EUCLIDEAN_DISTANCE_HPP
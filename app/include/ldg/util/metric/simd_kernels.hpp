@@ -0,0 +1,806 @@
+#ifndef LDG_CORE_SIMD_KERNELS_HPP
+#define LDG_CORE_SIMD_KERNELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <Eigen/Core>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LDG_SIMD_X86
+#include <immintrin.h>
+#define LDG_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define LDG_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,fma")))
+#endif
+
+namespace ldg::simd
+{
+    /**
+     * Instruction sets for which explicit kernels exist, ordered by vector width.
+     */
+    enum InstructionSet
+    {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    constexpr Eigen::Index MIN_FIXED_LEN = 16;      // Shorter fixed-size vectors are left to the inlined Eigen code.
+    constexpr size_t INT32_FLUSH_LEN = 1 << 17;     // Number of bytes after which 32-bit integer lanes are flushed to 64 bits.
+    constexpr size_t BOUND_CHECK_LEN = 256;         // Number of elements between checks of the bound of a distance.
+    constexpr double ABANDONED = std::numeric_limits<double>::infinity();   // Result of a distance that exceeded its bound.
+
+    /**
+     * Detect the widest instruction set supported by the CPU.
+     *
+     * @return
+     */
+    inline InstructionSet detectInstructionSet()
+    {
+#ifdef LDG_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return AVX2;
+#endif
+        return SCALAR;
+    }
+
+    /**
+     * Get the instruction set used by the kernels. It is detected once, such that the binary can be built generically.
+     *
+     * @return
+     */
+    inline InstructionSet getInstructionSet()
+    {
+        static const InstructionSet instruction_set = detectInstructionSet();
+        return instruction_set;
+    }
+
+    /**
+     * Whether the explicit kernels can be used for a vector expression. This requires contiguous data of a supported scalar type.
+     * Short fixed-size vectors are excluded, since the call would cost more than the inlined Eigen code.
+     *
+     * @tparam Derived
+     * @return
+     */
+    template<typename Derived>
+    constexpr bool supportsKernels()
+    {
+        using Scalar = typename Derived::Scalar;
+#ifdef LDG_SIMD_X86
+        return (std::is_same_v<Scalar, double> || std::is_same_v<Scalar, float> || std::is_same_v<Scalar, uint8_t>)
+            && (Derived::SizeAtCompileTime == Eigen::Dynamic || Derived::SizeAtCompileTime >= MIN_FIXED_LEN)
+            && (Derived::Flags & Eigen::DirectAccessBit) && Derived::InnerStrideAtCompileTime == 1;
+#else
+        return false;
+#endif
+    }
+
+#ifdef LDG_SIMD_X86
+// GCC 12 falsely reports the intentionally undefined registers inside the AVX-512 extract intrinsics as uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    LDG_TARGET_AVX2 inline double horizontalSum(__m256d sum)
+    {
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    LDG_TARGET_AVX2 inline float horizontalSum(__m256 sum)
+    {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        return _mm_cvtss_f32(_mm_add_ss(half, _mm_movehdup_ps(half)));
+    }
+
+    LDG_TARGET_AVX2 inline int64_t horizontalSum(__m256i sum)
+    {
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        return _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+    }
+
+    /**
+     * Widen the 32-bit lanes of an accumulator and add them to a 64-bit accumulator.
+     */
+    LDG_TARGET_AVX2 inline __m256i flushToInt64(__m256i sum, __m256i sum_64)
+    {
+        sum_64 = _mm256_add_epi64(sum_64, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(sum)));
+        return _mm256_add_epi64(sum_64, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(sum, 1)));
+    }
+
+    LDG_TARGET_AVX2 inline double squaredDistanceAvx2(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        __m256d sum_0 = _mm256_setzero_pd();
+        __m256d sum_1 = _mm256_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 8 <= len; idx += 8) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(_mm256_add_pd(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            __m256d diff_0 = _mm256_sub_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx));
+            __m256d diff_1 = _mm256_sub_pd(_mm256_loadu_pd(lhs + idx + 4), _mm256_loadu_pd(rhs + idx + 4));
+            sum_0 = _mm256_fmadd_pd(diff_0, diff_0, sum_0);
+            sum_1 = _mm256_fmadd_pd(diff_1, diff_1, sum_1);
+        }
+        for (; idx + 4 <= len; idx += 4) {
+            __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx));
+            sum_0 = _mm256_fmadd_pd(diff, diff, sum_0);
+        }
+
+        double sum = horizontalSum(_mm256_add_pd(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            double diff = lhs[idx] - rhs[idx];
+            sum += diff * diff;
+        }
+        return sum;
+    }
+
+    LDG_TARGET_AVX2 inline double squaredDistanceAvx2(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        __m256 sum_0 = _mm256_setzero_ps();
+        __m256 sum_1 = _mm256_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(_mm256_add_ps(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            __m256 diff_0 = _mm256_sub_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx));
+            __m256 diff_1 = _mm256_sub_ps(_mm256_loadu_ps(lhs + idx + 8), _mm256_loadu_ps(rhs + idx + 8));
+            sum_0 = _mm256_fmadd_ps(diff_0, diff_0, sum_0);
+            sum_1 = _mm256_fmadd_ps(diff_1, diff_1, sum_1);
+        }
+        for (; idx + 8 <= len; idx += 8) {
+            __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx));
+            sum_0 = _mm256_fmadd_ps(diff, diff, sum_0);
+        }
+
+        float sum = horizontalSum(_mm256_add_ps(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            float diff = lhs[idx] - rhs[idx];
+            sum += diff * diff;
+        }
+        return sum;
+    }
+
+    /**
+     * Bytes are widened to 16 bits, after which pairs of squares are summed into 32-bit lanes using madd.
+     */
+    LDG_TARGET_AVX2 inline double squaredDistanceAvx2(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        __m256i sum_64 = _mm256_setzero_si256();
+        size_t idx = 0;
+        while (idx + 32 <= len) {
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t end = std::min(len, idx + INT32_FLUSH_LEN); idx + 32 <= end; idx += 32) {
+                if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(flushToInt64(sum, sum_64)) > bound)
+                    return ABANDONED;
+                __m256i lhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + idx));
+                __m256i rhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + idx));
+                __m256i diff = _mm256_or_si256(_mm256_subs_epu8(lhs_bytes, rhs_bytes), _mm256_subs_epu8(rhs_bytes, lhs_bytes));
+                __m256i diff_low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(diff));
+                __m256i diff_high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(diff, 1));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(diff_low, diff_low));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(diff_high, diff_high));
+            }
+            sum_64 = flushToInt64(sum, sum_64);
+        }
+
+        int64_t sum = horizontalSum(sum_64);
+        for (; idx < len; ++idx) {
+            int32_t diff = int32_t(lhs[idx]) - int32_t(rhs[idx]);
+            sum += diff * diff;
+        }
+        return static_cast<double>(sum);
+    }
+
+    LDG_TARGET_AVX2 inline double dotProductAvx2(const double *lhs, const double *rhs, size_t len)
+    {
+        __m256d sum_0 = _mm256_setzero_pd();
+        __m256d sum_1 = _mm256_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 8 <= len; idx += 8) {
+            sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx), sum_0);
+            sum_1 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + idx + 4), _mm256_loadu_pd(rhs + idx + 4), sum_1);
+        }
+        for (; idx + 4 <= len; idx += 4) {
+            sum_0 = _mm256_fmadd_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx), sum_0);
+        }
+
+        double sum = horizontalSum(_mm256_add_pd(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            sum += lhs[idx] * rhs[idx];
+        }
+        return sum;
+    }
+
+    LDG_TARGET_AVX2 inline double dotProductAvx2(const float *lhs, const float *rhs, size_t len)
+    {
+        __m256 sum_0 = _mm256_setzero_ps();
+        __m256 sum_1 = _mm256_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            sum_0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx), sum_0);
+            sum_1 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + idx + 8), _mm256_loadu_ps(rhs + idx + 8), sum_1);
+        }
+        for (; idx + 8 <= len; idx += 8) {
+            sum_0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx), sum_0);
+        }
+
+        float sum = horizontalSum(_mm256_add_ps(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            sum += lhs[idx] * rhs[idx];
+        }
+        return sum;
+    }
+
+    LDG_TARGET_AVX2 inline double dotProductAvx2(const uint8_t *lhs, const uint8_t *rhs, size_t len)
+    {
+        __m256i sum_64 = _mm256_setzero_si256();
+        size_t idx = 0;
+        while (idx + 32 <= len) {
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t end = std::min(len, idx + INT32_FLUSH_LEN); idx + 32 <= end; idx += 32) {
+                __m256i lhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + idx));
+                __m256i rhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + idx));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(lhs_bytes)),
+                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(rhs_bytes))
+                ));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(lhs_bytes, 1)),
+                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(rhs_bytes, 1))
+                ));
+            }
+            sum_64 = flushToInt64(sum, sum_64);
+        }
+
+        int64_t sum = horizontalSum(sum_64);
+        for (; idx < len; ++idx) {
+            sum += int32_t(lhs[idx]) * int32_t(rhs[idx]);
+        }
+        return static_cast<double>(sum);
+    }
+
+    /**
+     * Average rows into a result. The rows are added to a zeroed sum in order, such that the result is exactly the same as for
+     * the Eigen expression.
+     */
+    LDG_TARGET_AVX2 inline void averageRowsAvx2(const double *const *rows, size_t num_rows, double *result, size_t len)
+    {
+        __m256d divisor = _mm256_set1_pd(static_cast<double>(std::max<size_t>(1, num_rows)));
+        size_t idx = 0;
+        for (; idx + 4 <= len; idx += 4) {
+            __m256d sum = _mm256_setzero_pd();
+            for (size_t row = 0; row < num_rows; ++row)
+                sum = _mm256_add_pd(sum, _mm256_loadu_pd(rows[row] + idx));
+            _mm256_storeu_pd(result + idx, _mm256_div_pd(sum, divisor));
+        }
+        for (; idx < len; ++idx) {
+            double sum = 0.;
+            for (size_t row = 0; row < num_rows; ++row)
+                sum += rows[row][idx];
+            result[idx] = sum / static_cast<double>(std::max<size_t>(1, num_rows));
+        }
+    }
+
+    LDG_TARGET_AVX2 inline void averageRowsAvx2(const float *const *rows, size_t num_rows, float *result, size_t len)
+    {
+        __m256 divisor = _mm256_set1_ps(static_cast<float>(std::max<size_t>(1, num_rows)));
+        size_t idx = 0;
+        for (; idx + 8 <= len; idx += 8) {
+            __m256 sum = _mm256_setzero_ps();
+            for (size_t row = 0; row < num_rows; ++row)
+                sum = _mm256_add_ps(sum, _mm256_loadu_ps(rows[row] + idx));
+            _mm256_storeu_ps(result + idx, _mm256_div_ps(sum, divisor));
+        }
+        for (; idx < len; ++idx) {
+            float sum = 0.f;
+            for (size_t row = 0; row < num_rows; ++row)
+                sum += rows[row][idx];
+            result[idx] = sum / static_cast<float>(std::max<size_t>(1, num_rows));
+        }
+    }
+
+    /**
+     * Sums of absolute differences. The sign bit is cleared to take the absolute value of floating point differences.
+     */
+    LDG_TARGET_AVX2 inline double absoluteDistanceAvx2(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        const __m256d sign_mask = _mm256_set1_pd(-0.);
+        __m256d sum_0 = _mm256_setzero_pd();
+        __m256d sum_1 = _mm256_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 8 <= len; idx += 8) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(_mm256_add_pd(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            sum_0 = _mm256_add_pd(sum_0, _mm256_andnot_pd(sign_mask, _mm256_sub_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx))));
+            sum_1 = _mm256_add_pd(sum_1, _mm256_andnot_pd(sign_mask, _mm256_sub_pd(_mm256_loadu_pd(lhs + idx + 4), _mm256_loadu_pd(rhs + idx + 4))));
+        }
+        for (; idx + 4 <= len; idx += 4) {
+            sum_0 = _mm256_add_pd(sum_0, _mm256_andnot_pd(sign_mask, _mm256_sub_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx))));
+        }
+
+        double sum = horizontalSum(_mm256_add_pd(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            sum += std::abs(lhs[idx] - rhs[idx]);
+        }
+        return sum;
+    }
+
+    LDG_TARGET_AVX2 inline double absoluteDistanceAvx2(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        const __m256 sign_mask = _mm256_set1_ps(-0.f);
+        __m256 sum_0 = _mm256_setzero_ps();
+        __m256 sum_1 = _mm256_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(_mm256_add_ps(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            sum_0 = _mm256_add_ps(sum_0, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx))));
+            sum_1 = _mm256_add_ps(sum_1, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(lhs + idx + 8), _mm256_loadu_ps(rhs + idx + 8))));
+        }
+        for (; idx + 8 <= len; idx += 8) {
+            sum_0 = _mm256_add_ps(sum_0, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx))));
+        }
+
+        float sum = horizontalSum(_mm256_add_ps(sum_0, sum_1));
+        for (; idx < len; ++idx) {
+            sum += std::abs(lhs[idx] - rhs[idx]);
+        }
+        return sum;
+    }
+
+    /**
+     * Bytes use the dedicated SAD instruction, which sums groups of 8 absolute differences directly into 64-bit lanes.
+     */
+    LDG_TARGET_AVX2 inline double absoluteDistanceAvx2(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        __m256i sum_64 = _mm256_setzero_si256();
+        size_t idx = 0;
+        for (; idx + 32 <= len; idx += 32) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && horizontalSum(sum_64) > bound)
+                return ABANDONED;
+            __m256i lhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + idx));
+            __m256i rhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + idx));
+            sum_64 = _mm256_add_epi64(sum_64, _mm256_sad_epu8(lhs_bytes, rhs_bytes));
+        }
+
+        int64_t sum = horizontalSum(sum_64);
+        for (; idx < len; ++idx) {
+            sum += std::abs(int32_t(lhs[idx]) - int32_t(rhs[idx]));
+        }
+        return static_cast<double>(sum);
+    }
+
+    /**
+     * Maximum absolute differences. Each lane keeps its own maximum, which are combined at the end.
+     */
+        LDG_TARGET_AVX2 inline double maximumDistanceAvx2(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        const __m256d sign_mask = _mm256_set1_pd(-0.);
+        const __m256d bound_lanes = _mm256_set1_pd(bound);
+        __m256d maximum = _mm256_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 4 <= len; idx += 4) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm256_movemask_pd(_mm256_cmp_pd(maximum, bound_lanes, _CMP_GT_OQ)) != 0)
+                return ABANDONED;
+            maximum = _mm256_max_pd(maximum, _mm256_andnot_pd(sign_mask, _mm256_sub_pd(_mm256_loadu_pd(lhs + idx), _mm256_loadu_pd(rhs + idx))));
+        }
+
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, maximum);
+        double result = *std::max_element(lanes, lanes + 4);
+        for (; idx < len; ++idx) {
+            result = std::max(result, std::abs(lhs[idx] - rhs[idx]));
+        }
+        return result;
+    }
+
+        LDG_TARGET_AVX2 inline double maximumDistanceAvx2(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        const __m256 sign_mask = _mm256_set1_ps(-0.f);
+        const __m256 bound_lanes = _mm256_set1_ps(static_cast<float>(bound));
+        __m256 maximum = _mm256_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 8 <= len; idx += 8) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm256_movemask_ps(_mm256_cmp_ps(maximum, bound_lanes, _CMP_GT_OQ)) != 0)
+                return ABANDONED;
+            maximum = _mm256_max_ps(maximum, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(lhs + idx), _mm256_loadu_ps(rhs + idx))));
+        }
+
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, maximum);
+        float result = *std::max_element(lanes, lanes + 8);
+        for (; idx < len; ++idx) {
+            result = std::max(result, std::abs(lhs[idx] - rhs[idx]));
+        }
+        return result;
+    }
+
+        /**
+     * A lane exceeds the bound if taking the maximum with the bound changes it. Bounds of 255 or more can never be exceeded.
+     */
+    LDG_TARGET_AVX2 inline double maximumDistanceAvx2(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        const bool is_bounded = bound < 255.;
+        const __m256i bound_lanes = _mm256_set1_epi8(static_cast<char>(static_cast<uint8_t>(std::clamp(bound, 0., 255.))));
+        __m256i maximum = _mm256_setzero_si256();
+        size_t idx = 0;
+        for (; idx + 32 <= len; idx += 32) {
+            if (is_bounded && idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(maximum, bound_lanes), bound_lanes)) != -1)
+                return ABANDONED;
+            __m256i lhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + idx));
+            __m256i rhs_bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + idx));
+            maximum = _mm256_max_epu8(maximum, _mm256_or_si256(_mm256_subs_epu8(lhs_bytes, rhs_bytes), _mm256_subs_epu8(rhs_bytes, lhs_bytes)));
+        }
+
+        alignas(32) uint8_t lanes[32];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), maximum);
+        int32_t result = *std::max_element(lanes, lanes + 32);
+        for (; idx < len; ++idx) {
+            result = std::max(result, std::abs(int32_t(lhs[idx]) - int32_t(rhs[idx])));
+        }
+        return static_cast<double>(result);
+    }
+
+    LDG_TARGET_AVX512 inline __m512i flushToInt64(__m512i sum, __m512i sum_64)
+    {
+        sum_64 = _mm512_add_epi64(sum_64, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(sum)));
+        return _mm512_add_epi64(sum_64, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(sum, 1)));
+    }
+
+    /**
+     * The AVX-512 kernels handle the tail with masked loads, so no scalar loop is needed.
+     */
+    LDG_TARGET_AVX512 inline double squaredDistanceAvx512(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        __m512d sum_0 = _mm512_setzero_pd();
+        __m512d sum_1 = _mm512_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            __m512d diff_0 = _mm512_sub_pd(_mm512_loadu_pd(lhs + idx), _mm512_loadu_pd(rhs + idx));
+            __m512d diff_1 = _mm512_sub_pd(_mm512_loadu_pd(lhs + idx + 8), _mm512_loadu_pd(rhs + idx + 8));
+            sum_0 = _mm512_fmadd_pd(diff_0, diff_0, sum_0);
+            sum_1 = _mm512_fmadd_pd(diff_1, diff_1, sum_1);
+        }
+        for (; idx < len; idx += 8) {
+            __mmask8 mask = len - idx >= 8 ? __mmask8(0xFF) : __mmask8((1u << (len - idx)) - 1);
+            __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, lhs + idx), _mm512_maskz_loadu_pd(mask, rhs + idx));
+            sum_0 = _mm512_fmadd_pd(diff, diff, sum_0);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double squaredDistanceAvx512(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        __m512 sum_0 = _mm512_setzero_ps();
+        __m512 sum_1 = _mm512_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 32 <= len; idx += 32) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_ps(_mm512_add_ps(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            __m512 diff_0 = _mm512_sub_ps(_mm512_loadu_ps(lhs + idx), _mm512_loadu_ps(rhs + idx));
+            __m512 diff_1 = _mm512_sub_ps(_mm512_loadu_ps(lhs + idx + 16), _mm512_loadu_ps(rhs + idx + 16));
+            sum_0 = _mm512_fmadd_ps(diff_0, diff_0, sum_0);
+            sum_1 = _mm512_fmadd_ps(diff_1, diff_1, sum_1);
+        }
+        for (; idx < len; idx += 16) {
+            __mmask16 mask = len - idx >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (len - idx)) - 1);
+            __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, lhs + idx), _mm512_maskz_loadu_ps(mask, rhs + idx));
+            sum_0 = _mm512_fmadd_ps(diff, diff, sum_0);
+        }
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double squaredDistanceAvx512(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        __m512i sum_64 = _mm512_setzero_si512();
+        size_t idx = 0;
+        while (idx < len) {
+            __m512i sum = _mm512_setzero_si512();
+            for (size_t end = std::min(len, idx + INT32_FLUSH_LEN); idx < end; idx += 64) {
+                if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_epi64(flushToInt64(sum, sum_64)) > bound)
+                    return ABANDONED;
+                __mmask64 mask = end - idx >= 64 ? ~__mmask64(0) : (__mmask64(1) << (end - idx)) - 1;
+                __m512i lhs_bytes = _mm512_maskz_loadu_epi8(mask, lhs + idx);
+                __m512i rhs_bytes = _mm512_maskz_loadu_epi8(mask, rhs + idx);
+                __m512i diff = _mm512_or_si512(_mm512_subs_epu8(lhs_bytes, rhs_bytes), _mm512_subs_epu8(rhs_bytes, lhs_bytes));
+                __m512i diff_low = _mm512_cvtepu8_epi16(_mm512_castsi512_si256(diff));
+                __m512i diff_high = _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(diff, 1));
+                sum = _mm512_add_epi32(sum, _mm512_madd_epi16(diff_low, diff_low));
+                sum = _mm512_add_epi32(sum, _mm512_madd_epi16(diff_high, diff_high));
+            }
+            sum_64 = flushToInt64(sum, sum_64);
+        }
+        return static_cast<double>(_mm512_reduce_add_epi64(sum_64));
+    }
+
+    LDG_TARGET_AVX512 inline double dotProductAvx512(const double *lhs, const double *rhs, size_t len)
+    {
+        __m512d sum_0 = _mm512_setzero_pd();
+        __m512d sum_1 = _mm512_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            sum_0 = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + idx), _mm512_loadu_pd(rhs + idx), sum_0);
+            sum_1 = _mm512_fmadd_pd(_mm512_loadu_pd(lhs + idx + 8), _mm512_loadu_pd(rhs + idx + 8), sum_1);
+        }
+        for (; idx < len; idx += 8) {
+            __mmask8 mask = len - idx >= 8 ? __mmask8(0xFF) : __mmask8((1u << (len - idx)) - 1);
+            sum_0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, lhs + idx), _mm512_maskz_loadu_pd(mask, rhs + idx), sum_0);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double dotProductAvx512(const float *lhs, const float *rhs, size_t len)
+    {
+        __m512 sum_0 = _mm512_setzero_ps();
+        __m512 sum_1 = _mm512_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 32 <= len; idx += 32) {
+            sum_0 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + idx), _mm512_loadu_ps(rhs + idx), sum_0);
+            sum_1 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + idx + 16), _mm512_loadu_ps(rhs + idx + 16), sum_1);
+        }
+        for (; idx < len; idx += 16) {
+            __mmask16 mask = len - idx >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (len - idx)) - 1);
+            sum_0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, lhs + idx), _mm512_maskz_loadu_ps(mask, rhs + idx), sum_0);
+        }
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double dotProductAvx512(const uint8_t *lhs, const uint8_t *rhs, size_t len)
+    {
+        __m512i sum_64 = _mm512_setzero_si512();
+        size_t idx = 0;
+        while (idx < len) {
+            __m512i sum = _mm512_setzero_si512();
+            for (size_t end = std::min(len, idx + INT32_FLUSH_LEN); idx < end; idx += 64) {
+                __mmask64 mask = end - idx >= 64 ? ~__mmask64(0) : (__mmask64(1) << (end - idx)) - 1;
+                __m512i lhs_bytes = _mm512_maskz_loadu_epi8(mask, lhs + idx);
+                __m512i rhs_bytes = _mm512_maskz_loadu_epi8(mask, rhs + idx);
+                sum = _mm512_add_epi32(sum, _mm512_madd_epi16(
+                    _mm512_cvtepu8_epi16(_mm512_castsi512_si256(lhs_bytes)),
+                    _mm512_cvtepu8_epi16(_mm512_castsi512_si256(rhs_bytes))
+                ));
+                sum = _mm512_add_epi32(sum, _mm512_madd_epi16(
+                    _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(lhs_bytes, 1)),
+                    _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(rhs_bytes, 1))
+                ));
+            }
+            sum_64 = _mm512_add_epi64(sum_64, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(sum)));
+            sum_64 = _mm512_add_epi64(sum_64, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(sum, 1)));
+        }
+        return static_cast<double>(_mm512_reduce_add_epi64(sum_64));
+    }
+
+    LDG_TARGET_AVX512 inline void averageRowsAvx512(const double *const *rows, size_t num_rows, double *result, size_t len)
+    {
+        __m512d divisor = _mm512_set1_pd(static_cast<double>(std::max<size_t>(1, num_rows)));
+        for (size_t idx = 0; idx < len; idx += 8) {
+            __mmask8 mask = len - idx >= 8 ? __mmask8(0xFF) : __mmask8((1u << (len - idx)) - 1);
+            __m512d sum = _mm512_setzero_pd();
+            for (size_t row = 0; row < num_rows; ++row)
+                sum = _mm512_add_pd(sum, _mm512_maskz_loadu_pd(mask, rows[row] + idx));
+            _mm512_mask_storeu_pd(result + idx, mask, _mm512_div_pd(sum, divisor));
+        }
+    }
+
+    LDG_TARGET_AVX512 inline void averageRowsAvx512(const float *const *rows, size_t num_rows, float *result, size_t len)
+    {
+        __m512 divisor = _mm512_set1_ps(static_cast<float>(std::max<size_t>(1, num_rows)));
+        for (size_t idx = 0; idx < len; idx += 16) {
+            __mmask16 mask = len - idx >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (len - idx)) - 1);
+            __m512 sum = _mm512_setzero_ps();
+            for (size_t row = 0; row < num_rows; ++row)
+                sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(mask, rows[row] + idx));
+            _mm512_mask_storeu_ps(result + idx, mask, _mm512_div_ps(sum, divisor));
+        }
+    }
+
+    LDG_TARGET_AVX512 inline double absoluteDistanceAvx512(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        __m512d sum_0 = _mm512_setzero_pd();
+        __m512d sum_1 = _mm512_setzero_pd();
+        size_t idx = 0;
+        for (; idx + 16 <= len; idx += 16) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            sum_0 = _mm512_add_pd(sum_0, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(lhs + idx), _mm512_loadu_pd(rhs + idx))));
+            sum_1 = _mm512_add_pd(sum_1, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(lhs + idx + 8), _mm512_loadu_pd(rhs + idx + 8))));
+        }
+        for (; idx < len; idx += 8) {
+            __mmask8 mask = len - idx >= 8 ? __mmask8(0xFF) : __mmask8((1u << (len - idx)) - 1);
+            sum_0 = _mm512_add_pd(sum_0, _mm512_abs_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(mask, lhs + idx), _mm512_maskz_loadu_pd(mask, rhs + idx))));
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double absoluteDistanceAvx512(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        __m512 sum_0 = _mm512_setzero_ps();
+        __m512 sum_1 = _mm512_setzero_ps();
+        size_t idx = 0;
+        for (; idx + 32 <= len; idx += 32) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_ps(_mm512_add_ps(sum_0, sum_1)) > bound)
+                return ABANDONED;
+            sum_0 = _mm512_add_ps(sum_0, _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(lhs + idx), _mm512_loadu_ps(rhs + idx))));
+            sum_1 = _mm512_add_ps(sum_1, _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(lhs + idx + 16), _mm512_loadu_ps(rhs + idx + 16))));
+        }
+        for (; idx < len; idx += 16) {
+            __mmask16 mask = len - idx >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (len - idx)) - 1);
+            sum_0 = _mm512_add_ps(sum_0, _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, lhs + idx), _mm512_maskz_loadu_ps(mask, rhs + idx))));
+        }
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum_0, sum_1));
+    }
+
+    LDG_TARGET_AVX512 inline double absoluteDistanceAvx512(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        __m512i sum_64 = _mm512_setzero_si512();
+        for (size_t idx = 0; idx < len; idx += 64) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_reduce_add_epi64(sum_64) > bound)
+                return ABANDONED;
+            __mmask64 mask = len - idx >= 64 ? ~__mmask64(0) : (__mmask64(1) << (len - idx)) - 1;
+            sum_64 = _mm512_add_epi64(sum_64, _mm512_sad_epu8(_mm512_maskz_loadu_epi8(mask, lhs + idx), _mm512_maskz_loadu_epi8(mask, rhs + idx)));
+        }
+        return static_cast<double>(_mm512_reduce_add_epi64(sum_64));
+    }
+
+        LDG_TARGET_AVX512 inline double maximumDistanceAvx512(const double *lhs, const double *rhs, size_t len, double bound)
+    {
+        const __m512d bound_lanes = _mm512_set1_pd(bound);
+        __m512d maximum = _mm512_setzero_pd();
+        for (size_t idx = 0; idx < len; idx += 8) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_cmp_pd_mask(maximum, bound_lanes, _CMP_GT_OQ) != 0)
+                return ABANDONED;
+            __mmask8 mask = len - idx >= 8 ? __mmask8(0xFF) : __mmask8((1u << (len - idx)) - 1);
+            maximum = _mm512_max_pd(maximum, _mm512_abs_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(mask, lhs + idx), _mm512_maskz_loadu_pd(mask, rhs + idx))));
+        }
+        return _mm512_reduce_max_pd(maximum);
+    }
+
+        LDG_TARGET_AVX512 inline double maximumDistanceAvx512(const float *lhs, const float *rhs, size_t len, double bound)
+    {
+        const __m512 bound_lanes = _mm512_set1_ps(static_cast<float>(bound));
+        __m512 maximum = _mm512_setzero_ps();
+        for (size_t idx = 0; idx < len; idx += 16) {
+            if (idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_cmp_ps_mask(maximum, bound_lanes, _CMP_GT_OQ) != 0)
+                return ABANDONED;
+            __mmask16 mask = len - idx >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (len - idx)) - 1);
+            maximum = _mm512_max_ps(maximum, _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, lhs + idx), _mm512_maskz_loadu_ps(mask, rhs + idx))));
+        }
+        return _mm512_reduce_max_ps(maximum);
+    }
+
+    LDG_TARGET_AVX512 inline double maximumDistanceAvx512(const uint8_t *lhs, const uint8_t *rhs, size_t len, double bound)
+    {
+        const bool is_bounded = bound < 255.;
+        const __m512i bound_lanes = _mm512_set1_epi8(static_cast<char>(static_cast<uint8_t>(std::clamp(bound, 0., 255.))));
+        __m512i maximum = _mm512_setzero_si512();
+        for (size_t idx = 0; idx < len; idx += 64) {
+            if (is_bounded && idx % BOUND_CHECK_LEN == 0 && idx > 0 && _mm512_cmpgt_epu8_mask(maximum, bound_lanes) != 0)
+                return ABANDONED;
+            __mmask64 mask = len - idx >= 64 ? ~__mmask64(0) : (__mmask64(1) << (len - idx)) - 1;
+            __m512i lhs_bytes = _mm512_maskz_loadu_epi8(mask, lhs + idx);
+            __m512i rhs_bytes = _mm512_maskz_loadu_epi8(mask, rhs + idx);
+            maximum = _mm512_max_epu8(maximum, _mm512_or_si512(_mm512_subs_epu8(lhs_bytes, rhs_bytes), _mm512_subs_epu8(rhs_bytes, lhs_bytes)));
+        }
+
+        // Widen the lanes to 32 bits, such that the maximum can be reduced by a single instruction
+        __m512i maximum_32 = _mm512_max_epu32(
+            _mm512_max_epu32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(maximum, 0)), _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(maximum, 1))),
+            _mm512_max_epu32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(maximum, 2)), _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(maximum, 3)))
+        );
+        return static_cast<double>(_mm512_reduce_max_epu32(maximum_32));
+    }
+#pragma GCC diagnostic pop
+#endif
+
+    /**
+     * Compute the sum of squared differences using the widest available kernel. Only valid if a kernel is available.
+     *
+     * @tparam Scalar
+     * @param lhs
+     * @param rhs
+     * @param len
+     * @param bound The kernel stops once the partial result exceeds this bound.
+     * @return The result, or ABANDONED if the bound was exceeded.
+     */
+    template<typename Scalar>
+    double squaredDistance(const Scalar *lhs, const Scalar *rhs, size_t len, double bound = std::numeric_limits<double>::infinity())
+    {
+#ifdef LDG_SIMD_X86
+        return getInstructionSet() == AVX512 ? squaredDistanceAvx512(lhs, rhs, len, bound) : squaredDistanceAvx2(lhs, rhs, len, bound);
+#else
+        return 0.;
+#endif
+    }
+
+    /**
+     * Compute the dot product using the widest available kernel. Only valid if a kernel is available.
+     *
+     * @tparam Scalar
+     * @param lhs
+     * @param rhs
+     * @param len
+     * @return
+     */
+    template<typename Scalar>
+    double dotProduct(const Scalar *lhs, const Scalar *rhs, size_t len)
+    {
+#ifdef LDG_SIMD_X86
+        return getInstructionSet() == AVX512 ? dotProductAvx512(lhs, rhs, len) : dotProductAvx2(lhs, rhs, len);
+#else
+        return 0.;
+#endif
+    }
+
+    /**
+     * Compute the sum of absolute differences using the widest available kernel. Only valid if a kernel is available.
+     *
+     * @tparam Scalar
+     * @param lhs
+     * @param rhs
+     * @param len
+     * @param bound The kernel stops once the partial result exceeds this bound.
+     * @return The result, or ABANDONED if the bound was exceeded.
+     */
+    template<typename Scalar>
+    double absoluteDistance(const Scalar *lhs, const Scalar *rhs, size_t len, double bound = std::numeric_limits<double>::infinity())
+    {
+#ifdef LDG_SIMD_X86
+        return getInstructionSet() == AVX512 ? absoluteDistanceAvx512(lhs, rhs, len, bound) : absoluteDistanceAvx2(lhs, rhs, len, bound);
+#else
+        return 0.;
+#endif
+    }
+
+    /**
+     * Compute the maximum absolute difference using the widest available kernel. Only valid if a kernel is available.
+     *
+     * @tparam Scalar
+     * @param lhs
+     * @param rhs
+     * @param len
+     * @param bound The kernel stops once the partial result exceeds this bound.
+     * @return The result, or ABANDONED if the bound was exceeded.
+     */
+    template<typename Scalar>
+    double maximumDistance(const Scalar *lhs, const Scalar *rhs, size_t len, double bound = std::numeric_limits<double>::infinity())
+    {
+#ifdef LDG_SIMD_X86
+        return getInstructionSet() == AVX512 ? maximumDistanceAvx512(lhs, rhs, len, bound) : maximumDistanceAvx2(lhs, rhs, len, bound);
+#else
+        return 0.;
+#endif
+    }
+
+    /**
+     * Average a number of rows into the result using the widest available kernel. Only valid if a kernel is available.
+     * Only floating point types are supported, since integer averages are rounded per element.
+     *
+     * @tparam Scalar
+     * @param rows
+     * @param num_rows
+     * @param result
+     * @param len
+     */
+    template<typename Scalar>
+    void averageRows(const Scalar *const *rows, size_t num_rows, Scalar *result, size_t len)
+    {
+        static_assert(std::is_floating_point_v<Scalar>, "Only floating point rows can be averaged by the kernels");
+#ifdef LDG_SIMD_X86
+        if (getInstructionSet() == AVX512) {
+            averageRowsAvx512(rows, num_rows, result, len);
+        } else {
+            averageRowsAvx2(rows, num_rows, result, len);
+        }
+#endif
+    }
+}
+
+#endif //LDG_CORE_SIMD_KERNELS_HPP
@@ -0,0 +1,63 @@
+#ifndef SQUARED_EUCLIDEAN_DISTANCE_HPP
+#define SQUARED_EUCLIDEAN_DISTANCE_HPP
+
+#include "app/include/ldg/model/vector_view.hpp"
+#include "kernels.hpp"
+
+namespace ldg
+{
+    /**
+     * Take the vector-length normalized squared euclidean distance between two data items.
+     * This is the square of the normalized euclidean distance, which avoids the square root per call.
+     *
+     * @tparam VectorType
+     * @param lhs
+     * @param rhs
+     * @param bound The computation may be abandoned once the distance is known to exceed this bound.
+     * @return 0 if the items are equal or if one of the items is nullptr. Infinity if the computation was abandoned.
+     */
+    template<typename VectorType>
+    double squaredEuclideanDistance(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound = std::numeric_limits<double>::infinity())
+    {
+        if (lhs == nullptr || rhs == nullptr)
+            return 0.;
+
+        auto num_elements = static_cast<double>((*lhs).size());
+        return squaredDistance(*lhs, *rhs, bound * num_elements) / num_elements;
+    }
+
+    /**
+     * Functor of the squared euclidean distance, such that it can be inlined into the algorithms it is passed to.
+     */
+    struct SquaredEuclideanDistance
+    {
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs) const
+        {
+            return squaredEuclideanDistance(lhs, rhs);
+        }
+
+        template<typename VectorType>
+        double operator()(VectorView<VectorType> const &lhs, VectorView<VectorType> const &rhs, double bound) const
+        {
+            return squaredEuclideanDistance(lhs, rhs, bound);
+        }
+
+        /**
+         * Compute the distance from a dot product and the norms of both items, using ||a - b||^2 = ||a||^2 + ||b||^2 - 2a.b.
+         *
+         * @param dot_product
+         * @param lhs_norm
+         * @param rhs_norm
+         * @param num_elements
+         * @return
+         */
+        static double fromDotProduct(double dot_product, double lhs_norm, double rhs_norm, size_t num_elements)
+        {
+            double squared_distance = lhs_norm * lhs_norm + rhs_norm * rhs_norm - 2. * dot_product;
+            return std::max(squared_distance, 0.) / static_cast<double>(num_elements);
+        }
+    };
+}
+
+#endif //SQUARED_EUCLIDEAN_DISTANCE_HPP
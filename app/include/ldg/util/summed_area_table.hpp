@@ -0,0 +1,183 @@
+#ifndef LDG_CORE_SUMMED_AREA_TABLE_HPP
+#define LDG_CORE_SUMMED_AREA_TABLE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "app/include/ldg/model/cell_position.hpp"
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+
+namespace ldg
+{
+    /**
+     * Summed-area table of the values of all nodes at a height, together with the number of non-void nodes.
+     * The average of any rectangle of nodes takes 4 lookups per element, regardless of the size of the rectangle.
+     * Integer data is summed exactly in 64-bit integers, while floating point data is summed in doubles.
+     * The table is kept for the height and parent version it was built for, such that an update only resums the positions
+     * below and to the right of the first node that was recomputed since. The row sums are kept for this, which also keeps the
+     * updated sums exactly equal to those of a full build.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    class SummedAreaTable
+    {
+        using Scalar = typename VectorType::Scalar;
+        using SumType = std::conditional_t<std::is_integral_v<Scalar>, int64_t, double>;
+
+        size_t num_rows = 0;    // Number of rows of the table, which is one more than the number of rows of nodes.
+        size_t num_cols = 0;    // Number of columns of the table, which is one more than the number of columns of nodes.
+        size_t element_len = 0;
+        size_t height = 0;
+        uint32_t parent_version = 0;    // Parent version the table was built for.
+        bool is_built = false;
+        std::vector<SumType> row_sums;  // Row-major sums of all nodes to the left of every position in its row, per element.
+        std::vector<SumType> sums;  // Row-major sums of all nodes above and to the left of every position, per element.
+        std::vector<int64_t> row_counts;
+        std::vector<int64_t> counts;
+
+        void sumRegion(QuadAssignmentTree<VectorType> &quad_tree, size_t min_y, size_t min_x);
+
+    public:
+        static constexpr bool isFasterThanSumming(size_t window_len);
+
+        void update(QuadAssignmentTree<VectorType> &quad_tree, size_t height);
+
+        VectorType getAverage(size_t min_y, size_t max_y, size_t min_x, size_t max_x) const;
+    };
+
+    /**
+     * Check if averaging a window of nodes around every node through the table is cheaper than summing the windows directly.
+     * Building the table takes about 3 accesses per sum and looking up a window takes 4, against window_len^2 values per window.
+     *
+     * @tparam VectorType
+     * @param window_len    Number of nodes per dimension of a window.
+     * @return
+     */
+    template<typename VectorType>
+    constexpr bool SummedAreaTable<VectorType>::isFasterThanSumming(size_t window_len)
+    {
+        return window_len * window_len * sizeof(Scalar) > 7 * sizeof(SumType);
+    }
+
+    /**
+     * Bring the table up-to-date with the nodes at a height. The whole table is built if it was built for another height, and is
+     * reused as is if no node at the height was recomputed since it was built. The parents should be computed beforehand.
+     *
+     * @tparam VectorType
+     * @param quad_tree
+     * @param height
+     */
+    template<typename VectorType>
+    void SummedAreaTable<VectorType>::update(QuadAssignmentTree<VectorType> &quad_tree, size_t height)
+    {
+        auto [height_num_rows, height_num_cols] = quad_tree.getBounds(height).second;
+        if (!is_built || this->height != height || num_rows != height_num_rows + 1 || num_cols != height_num_cols + 1) {
+            this->height = height;
+            num_rows = height_num_rows + 1;
+            num_cols = height_num_cols + 1;
+            element_len = quad_tree.getDataElementLen();
+            row_sums.assign(num_rows * num_cols * element_len, SumType(0));
+            sums.assign(num_rows * num_cols * element_len, SumType(0));
+            row_counts.assign(num_rows * num_cols, 0);
+            counts.assign(num_rows * num_cols, 0);
+            sumRegion(quad_tree, 1, 1);
+        } else if (parent_version != quad_tree.getParentVersion()) {
+            // Find the first row and column of which a node was recomputed, in table positions
+            size_t min_y = num_rows;
+            size_t min_x = num_cols;
+#pragma omp parallel for reduction(min:min_y, min_x) schedule(static)
+            for (size_t idx = 0; idx < height_num_rows * height_num_cols; ++idx) {
+                if (quad_tree.getNodeVersion(CellPosition{ height, idx }) > parent_version) {
+                    min_y = std::min(min_y, idx / height_num_cols + 1);
+                    min_x = std::min(min_x, idx % height_num_cols + 1);
+                }
+            }
+            if (min_y < num_rows)
+                sumRegion(quad_tree, min_y, min_x);
+        }
+
+        parent_version = quad_tree.getParentVersion();
+        is_built = true;
+    }
+
+    /**
+     * Resum all positions of the table from a position onwards in both dimensions, given that the other positions are up-to-date.
+     * The rows are summed in parallel, after which the columns are summed in parallel.
+     *
+     * @tparam VectorType
+     * @param quad_tree
+     * @param min_y First row of the table to resum, which is at least 1.
+     * @param min_x First column of the table to resum, which is at least 1.
+     */
+    template<typename VectorType>
+    void SummedAreaTable<VectorType>::sumRegion(QuadAssignmentTree<VectorType> &quad_tree, size_t min_y, size_t min_x)
+    {
+        size_t height_num_cols = num_cols - 1;
+
+#pragma omp parallel for schedule(static)
+        for (size_t y = min_y; y < num_rows; ++y) {
+            for (size_t x = min_x; x < num_cols; ++x) {
+                size_t index = rowMajorIndex(y, x, num_cols);
+                SumType *row_sum = row_sums.data() + index * element_len;
+                SumType const *previous_row_sum = row_sum - element_len;
+                auto value = quad_tree.getValue(CellPosition{ height, rowMajorIndex(y - 1, x - 1, height_num_cols) });
+                if (value != nullptr) {
+                    for (size_t idx = 0; idx < element_len; ++idx)
+                        row_sum[idx] = previous_row_sum[idx] + static_cast<SumType>(value.data()[idx]);
+                } else {
+                    std::copy(previous_row_sum, previous_row_sum + element_len, row_sum);
+                }
+                row_counts[index] = row_counts[index - 1] + (value != nullptr ? 1 : 0);
+            }
+        }
+
+        size_t row_len = num_cols * element_len;
+#pragma omp parallel for schedule(static)
+        for (size_t idx = min_x * element_len; idx < row_len; ++idx) {
+            for (size_t y = min_y; y < num_rows; ++y)
+                sums[y * row_len + idx] = sums[(y - 1) * row_len + idx] + row_sums[y * row_len + idx];
+        }
+
+#pragma omp parallel for schedule(static)
+        for (size_t x = min_x; x < num_cols; ++x) {
+            for (size_t y = min_y; y < num_rows; ++y)
+                counts[y * num_cols + x] = counts[(y - 1) * num_cols + x] + row_counts[y * num_cols + x];
+        }
+    }
+
+    /**
+     * Average the non-void nodes in a rectangle, in the same way as aggregate.
+     *
+     * @tparam VectorType
+     * @param min_y
+     * @param max_y Exclusive.
+     * @param min_x
+     * @param max_x Exclusive.
+     * @return
+     */
+    template<typename VectorType>
+    VectorType SummedAreaTable<VectorType>::getAverage(size_t min_y, size_t max_y, size_t min_x, size_t max_x) const
+    {
+        size_t top_left = rowMajorIndex(min_y, min_x, num_cols);
+        size_t top_right = rowMajorIndex(min_y, max_x, num_cols);
+        size_t bottom_left = rowMajorIndex(max_y, min_x, num_cols);
+        size_t bottom_right = rowMajorIndex(max_y, max_x, num_cols);
+        SumType divisor = std::max<SumType>(1, counts[bottom_right] - counts[bottom_left] - counts[top_right] + counts[top_left]);
+
+        VectorType result(element_len);
+        for (size_t idx = 0; idx < element_len; ++idx) {
+            SumType sum = sums[bottom_right * element_len + idx] - sums[bottom_left * element_len + idx]
+                - sums[top_right * element_len + idx] + sums[top_left * element_len + idx];
+            if constexpr (std::is_integral_v<Scalar>) {
+                result(idx) = static_cast<Scalar>((sum + divisor / 2) / divisor);
+            } else {
+                result(idx) = static_cast<Scalar>(sum / divisor);
+            }
+        }
+        return result;
+    }
+}
+
+#endif //LDG_CORE_SUMMED_AREA_TABLE_HPP
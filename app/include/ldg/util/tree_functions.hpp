@@ -30,15 +30,18 @@ namespace ldg
 
     /**
      * Compute the parent of the quad tree based on the parent type.
+     * Parents are overwritten in place, so no allocations are made. Only dirty parents are recomputed, after which their own
+     * parent is marked dirty, such that changes propagate up the tree.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param distance_function
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     void computeParents(
         QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function
+        DistanceFunction distance_function
     ) {
         for (size_t height = 1; height < quad_tree.getDepth(); ++height) {
             auto [num_rows, num_cols] = quad_tree.getBounds(height).second;
@@ -46,25 +49,29 @@ namespace ldg
 #pragma omp parallel for schedule(static)
             for (size_t idx = 0; idx < num_rows * num_cols; ++idx) {
                 CellPosition position{ height, idx };
+                if (!quad_tree.isDirty(position))
+                    continue;
+
                 TreeWalker<VectorType> walker(position, num_rows, num_cols, quad_tree);
                 auto children = walker.getChildrenValues();
                 if (children[0] == nullptr && children[1] == nullptr && children[2] == nullptr && children[3] == nullptr) {
-                    quad_tree.setValue(position, nullptr);
+                    quad_tree.setParentValue(position, nullptr);
+                } else if (quad_tree.getParentType() == ParentType::NORMALIZED_AVERAGE) {
+                    aggregate(children, quad_tree.getMutableParentValue(position));
+                    quad_tree.updateParentNorm(position);
                 } else {
-                    std::vector<std::shared_ptr<VectorType>> child_vector(children.begin(), children.end());
-
-                    VectorType parent_value = quad_tree.getParentType() == ParentType::NORMALIZED_AVERAGE ?
-                        aggregate(child_vector, quad_tree.getDataElementLen()) :
-                        findMinimum(child_vector, distance_function);
-
-                    quad_tree.setValue(position, &parent_value);
+                    quad_tree.setParentValue(position, children[findMinimumIndex(children, distance_function)]);
                 }
+                quad_tree.clearDirty(position);
+                quad_tree.markParentDirty(position);
             }
         }
+        quad_tree.clearAllDirty();
     }
 
     /**
      * Randomize a given assignment.
+     * The assignment is shuffled in row-major order, such that the same seed gives the same assignment for every layout.
      * @param quad_tree
      *
      * @tparam VectorType
@@ -72,8 +79,12 @@ namespace ldg
     template<typename VectorType>
     void randomizeAssignment(QuadAssignmentTree<VectorType> &quad_tree)
     {
-        auto &assignment = quad_tree.getAssignment();
-        std::shuffle(assignment.begin(), assignment.begin() + quad_tree.getNumRows() * quad_tree.getNumCols(), program::RANDOMIZER);
+        size_t num_leaves = quad_tree.getNumRows() * quad_tree.getNumCols();
+        auto assignment = quad_tree.getRowMajorAssignment();
+        std::shuffle(assignment.begin(), assignment.begin() + num_leaves, program::RANDOMIZER);
+        for (size_t idx = 0; idx < num_leaves; ++idx)
+            quad_tree.setAssignmentValue(CellPosition{ 0, idx }, assignment[idx]);
+        quad_tree.markAllDirty();
     }
 
     /**
@@ -103,8 +114,8 @@ namespace ldg
         size_t new_num_cols = num_cols;
         size_t new_num_rows = num_rows;
         while (new_num_rows > 1 || new_num_cols > 1) {
-            new_num_cols = ceilDivideByFactor(new_num_cols, 2.);
-            new_num_rows = ceilDivideByFactor(new_num_rows, 2.);
+            new_num_cols = ceilDivideByPowerTwo(new_num_cols, 1);
+            new_num_rows = ceilDivideByPowerTwo(new_num_rows, 1);
             size += new_num_cols * new_num_rows;
         }
 
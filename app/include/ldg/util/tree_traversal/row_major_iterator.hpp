@@ -42,7 +42,7 @@ namespace ldg
 
         RowMajorIterator end();
 
-        std::shared_ptr<VectorType> getValue();
+        VectorView<VectorType> getValue();
 
         CellPosition &getPosition();
 
@@ -65,8 +65,8 @@ namespace ldg
         node{ height, 0 },
         quad_tree(quad_tree),
         offset(0),
-        num_rows(ceilDivideByPowerTwo(quad_tree.getNumRows(), height)),
-        num_cols(ceilDivideByPowerTwo(quad_tree.getNumCols(), height)),
+        num_rows(quad_tree.getBounds(height).second.first),
+        num_cols(quad_tree.getBounds(height).second.second),
         height_num_rows(num_rows),
         height_num_cols(num_cols)
     {
@@ -98,10 +98,10 @@ namespace ldg
         node(position),
         quad_tree(quad_tree),
         offset(offset),
-        num_rows(num_rows > 0 ? num_rows : ceilDivideByPowerTwo(quad_tree.getNumRows(), position.height)),
-        num_cols(num_cols > 0 ? num_cols : ceilDivideByPowerTwo(quad_tree.getNumCols(), position.height)),
-        height_num_rows(height_num_rows > 0 ? height_num_rows : ceilDivideByPowerTwo(quad_tree.getNumRows(), position.height)),
-        height_num_cols(height_num_cols > 0 ? height_num_cols : ceilDivideByPowerTwo(quad_tree.getNumCols(), position.height))
+        num_rows(num_rows > 0 ? num_rows : quad_tree.getBounds(position.height).second.first),
+        num_cols(num_cols > 0 ? num_cols : quad_tree.getBounds(position.height).second.second),
+        height_num_rows(height_num_rows > 0 ? height_num_rows : quad_tree.getBounds(position.height).second.first),
+        height_num_cols(height_num_cols > 0 ? height_num_cols : quad_tree.getBounds(position.height).second.second)
     {
     }
 
@@ -159,7 +159,7 @@ namespace ldg
      * @return
      */
     template<typename VectorType>
-    std::shared_ptr<VectorType> RowMajorIterator<VectorType>::getValue()
+    VectorView<VectorType> RowMajorIterator<VectorType>::getValue()
     {
         return quad_tree.getValue(node);
     }
@@ -7,13 +7,14 @@
 #include "app/include/ldg/model/quadrant.hpp"
 
 #include <array>
-#include <cmath>
+#include <tuple>
 
 namespace ldg
 {
     /**
      * Class for walking up and down the quad tree (classic quad tree traversal).
      * The state considers a parent of 4 child nodes. For leaf nodes, the children are empty. For the root, the parent is.
+     * Parents, children and dimensions are looked up in the tables of the quad tree.
      *
      * @tparam VectorType Type of the underlying data.
      */
@@ -39,15 +40,15 @@ namespace ldg
 
         void reposition(CellPosition position);
 
-        std::shared_ptr<VectorType> getNodeValue();
+        VectorView<VectorType> getNodeValue();
 
-        std::shared_ptr<VectorType> getParentValue();
+        VectorView<VectorType> getParentValue();
 
-        std::array<std::shared_ptr<VectorType>, 4> getChildrenValues();
+        std::array<VectorView<VectorType>, 4> getChildrenValues();
 
         size_t getParentIndex() const;
 
-        std::array<int, 4> getChildrenIndices();
+        std::array<long, 4> getChildrenIndices() const;
 
         RowMajorIterator<VectorType> getLeaves();
 
@@ -121,10 +122,9 @@ namespace ldg
             return false;
         }
 
-        ++node.height;
         node.index = getParentIndex();
-        num_cols = ceilDivideByFactor(num_cols, 2.);
-        num_rows = ceilDivideByFactor(num_rows, 2.);
+        ++node.height;
+        std::tie(num_rows, num_cols) = quad_tree.getBounds(node.height).second;
         return true;
     }
 
@@ -142,8 +142,8 @@ namespace ldg
             return false;
         }
 
-        auto child_indices = getChildrenIndices();
-        int new_index = -1;
+        auto &child_indices = quad_tree.getChildrenIndices(node);
+        long new_index = -1;
         switch (quadrant) {
             case NORTH_WEST:
                 new_index = child_indices[0];
@@ -165,10 +165,7 @@ namespace ldg
 
         node.index = static_cast<size_t>(new_index);
         --node.height;
-        // Tree is build bottom-up, so we need to recalculate this.
-        float factor = std::pow(2, node.height);
-        num_cols = ceilDivideByFactor(quad_tree.getNumCols(), factor);
-        num_rows = ceilDivideByFactor(quad_tree.getNumRows(), factor);
+        std::tie(num_rows, num_cols) = quad_tree.getBounds(node.height).second;
 
         return true;
     }
@@ -185,9 +182,7 @@ namespace ldg
     {
         node.index = position.index;
         node.height = position.height;
-        const float factor = std::pow(2, position.height);
-        num_rows = ceilDivideByFactor(quad_tree.getNumRows(), factor);
-        num_cols = ceilDivideByFactor(quad_tree.getNumCols(), factor);
+        std::tie(num_rows, num_cols) = quad_tree.getBounds(position.height).second;
     }
 
     /**
@@ -197,7 +192,7 @@ namespace ldg
      * @return The data of the current node if it exists, else nullptr.
      */
     template<typename VectorType>
-    std::shared_ptr<VectorType> TreeWalker<VectorType>::getNodeValue()
+    VectorView<VectorType> TreeWalker<VectorType>::getNodeValue()
     {
         return quad_tree.getValue(node);
     }
@@ -209,7 +204,7 @@ namespace ldg
      * @return The data of the parent node if it exists, else nullptr.
      */
     template<typename VectorType>
-    std::shared_ptr<VectorType> TreeWalker<VectorType>::getParentValue()
+    VectorView<VectorType> TreeWalker<VectorType>::getParentValue()
     {
         if (node.height == quad_tree.getDepth() - 1) {
             return nullptr;
@@ -226,13 +221,13 @@ namespace ldg
      * @return The data of the child nodes if they exist, else nullptr per child the child does not exist.
      */
     template<typename VectorType>
-    std::array<std::shared_ptr<VectorType>, 4> TreeWalker<VectorType>::getChildrenValues()
+    std::array<VectorView<VectorType>, 4> TreeWalker<VectorType>::getChildrenValues()
     {
         if (node.height == 0) {
             return { nullptr, nullptr, nullptr, nullptr };
         }
 
-        auto child_indices = getChildrenIndices();
+        auto &child_indices = quad_tree.getChildrenIndices(node);
         return {
             child_indices[0] >= 0 ? quad_tree.getValue(CellPosition{ node.height - 1, size_t(child_indices[0]) }) : nullptr,
             child_indices[1] >= 0 ? quad_tree.getValue(CellPosition{ node.height - 1, size_t(child_indices[1]) }) : nullptr,
@@ -250,34 +245,25 @@ namespace ldg
     template<typename VectorType>
     size_t TreeWalker<VectorType>::getParentIndex() const
     {
-        return rowMajorIndex(node.index / (2 * num_cols), (node.index % num_cols) / 2, ceilDivideByFactor(num_cols, 2.));
+        return quad_tree.getParentIndex(node);
     }
 
     /**
      * Get the indices of the children of this node.
      * Because the quad tree is build from the bottom up and hence does not always split up into 4, we need to check
-     * and also return nullptr if a child does not exist.
+     * and also return -1 if a child does not exist.
      *
      * @tparam VectorType
      * @return Child indices of the node, in the order: [NW, NE, SW, SE]. If it does not exist, -1 is returned.
      */
     template<typename VectorType>
-    std::array<int, 4> TreeWalker<VectorType>::getChildrenIndices()
+    std::array<long, 4> TreeWalker<VectorType>::getChildrenIndices() const
     {
-        float factor = std::pow(2, node.height - 1);
-        int new_num_cols = ceilDivideByFactor(quad_tree.getNumCols(), factor);
-        int new_num_rows = ceilDivideByFactor(quad_tree.getNumRows(), factor);
-
-        int new_row = (node.index / num_cols) * 2;
-        int new_col = (node.index % num_cols) * 2;
+        if (node.height == 0) {
+            return { -1, -1, -1, -1 };
+        }
 
-        int index = static_cast<int>(rowMajorIndex(new_row, new_col, new_num_cols));
-        return {
-            index,                                                                                      // North-west
-            new_col + 1 < new_num_cols ? index + 1 : -1,                                                // North-east
-            new_row + 1 < new_num_rows ? index + new_num_cols : -1,                                     // South-west
-            new_col + 1 < new_num_cols && new_row + 1 < new_num_rows ? index + new_num_cols + 1 : -1    // South-east
-        };
+        return quad_tree.getChildrenIndices(node);
     }
 
     /**
@@ -32,14 +32,15 @@ namespace program
     ) {
         std::string data_file_name = file_name + "-visualization-data";
 
-        // Copy and save the data. We skip void cells.
+        // Copy and save the data in the type it is stored in. We skip void cells.
+        using Scalar = typename VectorType::Scalar;
         size_t element_len = quad_tree.getDataElementLen();
         size_t num_elements = quad_tree.getData().size();
-        std::vector<double> data_copy(num_elements * element_len, 0.);  // Save as doubles regardless of the type.
+        std::vector<Scalar> data_copy(num_elements * element_len, Scalar(0));
         for (size_t idx = 0; idx < num_elements; ++idx) {
-            auto &data_ptr = quad_tree.getData()[idx];
-            if (data_ptr != nullptr) {
-                std::copy((*data_ptr).begin(), (*data_ptr).end(), data_copy.begin() + idx * element_len); // Assumes type is an Eigen Vector type
+            auto data_view = quad_tree.getData().getRow(idx);
+            if (data_view != nullptr) {
+                std::copy((*data_view).begin(), (*data_view).end(), data_copy.begin() + idx * element_len);
             }
         }
         adapter::compressBZipFile(data_copy, output_dir + data_file_name + ".raw.bz2");
@@ -49,6 +50,7 @@ namespace program
         visualization_input_config.grid_dims = { quad_tree.getNumRows(), quad_tree.getNumCols() };
         visualization_input_config.type = InputType::VISUALIZATION;
         visualization_input_config.data_dims = quad_tree.getDataDims();
+        visualization_input_config.data_type = mapScalarToDataType<Scalar>();
         visualization_input_config.num_elements  = quad_tree.getData().size();
         visualization_input_config.data_path = data_file_name + ".raw.bz2";
 
@@ -61,6 +63,7 @@ namespace program
      * If the visualization data is provided, then we need to map the parents to the closest child.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param output_dir
      * @param file_name
      * @param has_existing_visualization
@@ -68,15 +71,22 @@ namespace program
      * @param distance_function
      * @return Relative path to the generated assignment
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     std::string exportVisualizationAssignment(
         std::string output_dir,
         std::string file_name,
         bool has_existing_visualization,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function
+        DistanceFunction distance_function
     ) {
-        std::vector<int> assignment_copy(quad_tree.getAssignment().begin(), quad_tree.getAssignment().end());
+        // The assignment is exported in row-major order per height. Parents are not part of the assignment, but map to their own data row.
+        std::vector<int> assignment_copy(quad_tree.getData().size());
+        for (size_t height = 0; height < quad_tree.getDepth(); ++height) {
+            auto [start_end, dims] = quad_tree.getBounds(height);
+            for (size_t idx = 0; idx < start_end.second - start_end.first; ++idx) {
+                assignment_copy[start_end.first + idx] = static_cast<int>(quad_tree.getAssignmentValue({ height, idx }));
+            }
+        }
 
         if (has_existing_visualization) {
             // Replace all parents with the child that is closest to them
@@ -102,7 +112,7 @@ namespace program
 
         // Set all void cells to -1.
         for (size_t idx = 0; idx < assignment_copy.size(); ++idx) {
-            if (quad_tree.getData()[assignment_copy[idx]] == nullptr)
+            if (quad_tree.getData().isVoid(assignment_copy[idx]))
                 assignment_copy[idx] = -1;
         }
 
@@ -115,18 +125,19 @@ namespace program
      * Calculate the disparities, compress and save them and create and save an input config that points to it.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param output_dir
      * @param file_name
      * @param quad_tree
      * @param distance_function
      * @return Relative path to the generated config
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     std::string exportDisparity(
         std::string output_dir,
         std::string file_name,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function
+        DistanceFunction distance_function
     ) {
         std::string disparity_file_name = file_name + "-disparity";
         auto disparities = computeDisparity(quad_tree, distance_function);
@@ -139,29 +150,28 @@ namespace program
         disparity_configuration.data_path = disparity_file_name + ".raw.bz2";
         disparity_configuration.grid_dims = { quad_tree.getNumRows(), quad_tree.getNumCols() };
         disparity_configuration.data_dims = { 1, 1, 1 };
+        disparity_configuration.data_type = DataType::FLOAT64;
 
         disparity_configuration.toJSONFile(output_dir + disparity_file_name);
         return disparity_file_name + ".json";
     }
 
     /**
-     * Export the quad tree to storage.
+     * Write the files of a quad tree export.
      * Based on the export settings, this function either saves an RGB image, just the assignment or a configuration.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param distance_function
      * @param settings
      */
-    template<typename VectorType>
-    void exportQuadTree(
+    template<typename VectorType, typename DistanceFunction>
+    void exportQuadTreeFiles(
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
         ExportSettings &settings
     ) {
-        if (settings.log_only) {
-            return;
-        }
         if (settings.debug) {
             return saveQuadTreeRGBImages<VectorType>(quad_tree, settings.output_dir + settings.file_name);
         }
@@ -182,6 +192,32 @@ namespace program
             export_configuration.toJSONFile(settings.output_dir + settings.file_name + "-config");
         }
     }
+
+    /**
+     * Export the quad tree to storage, unless only logging is enabled.
+     * If a full-resolution export is set, it is used instead of exporting the (reduced) sorted tree.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param quad_tree
+     * @param distance_function
+     * @param settings
+     */
+    template<typename VectorType, typename DistanceFunction>
+    void exportQuadTree(
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        DistanceFunction distance_function,
+        ExportSettings &settings
+    ) {
+        if (settings.log_only) {
+            return;
+        }
+        if (settings.full_resolution_export) {
+            return settings.full_resolution_export(settings);
+        }
+
+        exportQuadTreeFiles(quad_tree, distance_function, settings);
+    }
 }
 
 #endif //NEW_LDG_EXPORT_HPP
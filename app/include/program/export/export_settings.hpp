@@ -2,6 +2,7 @@
 #define NEW_LDG_EXPORT_SETTINGS_HPP
 
 #include <string>
+#include <functional>
 #include "final_export_configuration.hpp"
 
 namespace program
@@ -20,6 +21,9 @@ namespace program
         bool debug = false; // Debug mode prints images across all heights for RGB configurations.
         bool export_visualization = false;
         bool export_data = false;   // In case we need to generate the images belonging to the data representations ourselves.
+
+        // Replaces the export of the sorted tree, e.g. to export the full-resolution data when sorting on reduced features.
+        std::function<void(ExportSettings &)> full_resolution_export;
     };
 } // program
 
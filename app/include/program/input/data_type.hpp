@@ -0,0 +1,85 @@
+#ifndef LDG_SSM_DATA_TYPE_HPP
+#define LDG_SSM_DATA_TYPE_HPP
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+
+namespace program
+{
+    /**
+     * Scalar types of data. This is used for both the type of the data files and the type used in memory.
+     */
+    enum DataType
+    {
+        FLOAT64,
+        FLOAT32,
+        UINT8,
+        UINT16
+    };
+
+    /**
+     * Map the name of a data type, as used in configurations, to the data type. Throws on unknown names.
+     *
+     * @param name
+     * @return
+     */
+    inline DataType mapStringToDataType(std::string const &name)
+    {
+        if (name == "float64")
+            return DataType::FLOAT64;
+        if (name == "float32")
+            return DataType::FLOAT32;
+        if (name == "uint8")
+            return DataType::UINT8;
+        if (name == "uint16")
+            return DataType::UINT16;
+
+        throw std::invalid_argument("Unknown data type \"" + name + "\"");
+    }
+
+    /**
+     * Map a data type to its name as used in configurations.
+     *
+     * @param type
+     * @return
+     */
+    inline std::string mapDataTypeToString(DataType type)
+    {
+        switch (type) {
+            case FLOAT32:
+                return "float32";
+            case UINT8:
+                return "uint8";
+            case UINT16:
+                return "uint16";
+            case FLOAT64:
+            default:
+                return "float64";
+        }
+    }
+
+    /**
+     * Map a C++ scalar type to its data type.
+     *
+     * @tparam Scalar
+     * @return
+     */
+    template<typename Scalar>
+    constexpr DataType mapScalarToDataType()
+    {
+        if constexpr (std::is_same_v<Scalar, float>) {
+            return DataType::FLOAT32;
+        } else if constexpr (std::is_same_v<Scalar, uint8_t>) {
+            return DataType::UINT8;
+        } else if constexpr (std::is_same_v<Scalar, uint16_t>) {
+            return DataType::UINT16;
+        } else {
+            static_assert(std::is_same_v<Scalar, double>, "Unsupported scalar type");
+            return DataType::FLOAT64;
+        }
+    }
+} // program
+
+#endif //LDG_SSM_DATA_TYPE_HPP
@@ -26,30 +26,89 @@ namespace program
      * @return
      */
     template<typename VectorType>
-    std::vector<std::shared_ptr<VectorType>> generateUniformRGBData(size_t num_rows, size_t num_cols)
+    ldg::FeatureMatrix<VectorType> generateUniformRGBData(size_t num_rows, size_t num_cols)
     {
-        // Generate quad tree structure space, initialized to an empty shared ptr
+        // Generate quad tree structure space
         size_t num_elements = num_rows * num_cols;
         size_t size = ldg::determineRequiredArrayCapacity(num_rows, num_cols);
-        auto data = std::vector<std::shared_ptr<Eigen::VectorXd>>(size, std::make_shared<Eigen::VectorXd>(Eigen::Vector3d::Zero(3)));
+        auto data = ldg::FeatureMatrix<VectorType>(size, 3);
 
         // Fill first cells with data
         for (size_t idx = 0; idx < size; ++idx) {
             if (idx < num_elements) {
                 size_t x = idx % num_cols;
                 size_t y = idx / num_cols;
+                using Scalar = typename VectorType::Scalar;
                 double r = x * (255. / (num_cols - 1));
                 double g = (x + y) * (255. / (num_cols + num_rows - 2));
                 double b = y * (255. / (num_rows - 1));
-                data[idx] = std::make_shared<VectorType>(VectorType{{std::round(r), std::round(g), std::round(b)}});
+                data.setRow(idx, VectorType{{static_cast<Scalar>(std::round(r)), static_cast<Scalar>(std::round(g)), static_cast<Scalar>(std::round(b))}});
             } else {
-                data[idx] = std::make_shared<VectorType>(VectorType::Zero(3));
+                data.setRow(idx, VectorType::Zero(3));
             }
         }
 
         return data;
     }
 
+    /**
+     * Determine the data type that should be used in memory from the input arguments.
+     * An explicitly passed data type takes precedence over the data type of the input config. Synthetic data uses doubles by default.
+     *
+     * @param result
+     * @return
+     */
+    DataType loadDataTypeFromInput(cxxopts::ParseResult const &result)
+    {
+        if (result.count("data_type"))
+            return static_cast<DataType>(result["data_type"].as<size_t>());
+        if (result["debug"].as<bool>() || result.count("config") != 1)
+            return DataType::FLOAT64;
+
+        InputConfiguration input_config;
+        input_config.fromJSONFile(result["config"].as<std::string>());
+        return input_config.data_type;
+    }
+
+    /**
+     * Determine the length of a single data element from the input arguments. Synthetic data always consists of RGB values.
+     *
+     * @param result
+     * @return
+     */
+    size_t loadDataElementLenFromInput(cxxopts::ParseResult const &result)
+    {
+        if (result["debug"].as<bool>() || result.count("config") != 1)
+            return 3;
+
+        InputConfiguration input_config;
+        input_config.fromJSONFile(result["config"].as<std::string>());
+        return input_config.data_dims[0] * input_config.data_dims[1] * input_config.data_dims[2];
+    }
+
+    /**
+     * Determine if the data should be normalized from the input arguments.
+     * Exits if normalization is requested for another distance function than the cosine distance, as it would change the distances
+     * that are sorted on. Warns if the data is memory-mapped, as it can not be normalized then.
+     *
+     * @param result
+     * @return
+     */
+    bool loadNormalizeFromInput(cxxopts::ParseResult const &result)
+    {
+        if (!result["normalize"].as<bool>())
+            return false;
+        if (static_cast<ldg::DistanceFunctionType>(result["distance_function"].as<size_t>()) != ldg::DistanceFunctionType::COSINE_SIMILARITY) {
+            std::cerr << "Normalization is only supported for the cosine distance. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (result["memory_map"].as<bool>()) {
+            std::cerr << "Warning: Memory-mapped data can not be normalized, using the data as is.\n";
+            return false;
+        }
+        return true;
+    }
+
     /**
      * Load the quad tree data from the input arguments.
      * Exits if arguments are invalid or missing.
@@ -59,16 +118,16 @@ namespace program
      * @return
      */
     template<typename VectorType>
-    std::tuple<std::vector<std::shared_ptr<VectorType>>, std::vector<size_t>, std::pair<size_t, size_t>, size_t, size_t, std::array<size_t, 3>> loadDataFromInput(cxxopts::ParseResult const &result)
+    std::tuple<ldg::FeatureMatrix<VectorType>, std::vector<size_t>, std::pair<size_t, size_t>, size_t, size_t, std::array<size_t, 3>> loadDataFromInput(cxxopts::ParseResult const &result)
     {
         // Debug mode: generate uniform synthetic RGB data
         if (result["debug"].as<bool>()) {
             size_t num_rows = result["rows"].as<size_t>();
             size_t num_cols = result["columns"].as<size_t>();
             auto data = generateUniformRGBData<VectorType>(num_rows, num_cols);
-            auto assignment = ldg::createAssignment(data.size());
+            auto assignment = ldg::createAssignment(num_rows * num_cols);
             return {
-                data,
+                std::move(data),
                 assignment,
                 {num_rows, num_cols},
                 static_cast<size_t>(std::ceil(std::log2(std::max(num_rows, num_cols))) + 1),
@@ -88,17 +147,17 @@ namespace program
 
         size_t last_separator = config_path.find_last_of("\\/");
         std::string config_dir = last_separator == std::string::npos ? "" : config_path.substr(0, last_separator + 1);
-        auto data = adapter::loadData<VectorType>(input_config, config_dir);
+        auto data = adapter::loadData<VectorType>(input_config, config_dir, result["memory_map"].as<bool>());
         auto [num_rows, num_cols] = input_config.grid_dims;
         std::vector<size_t> assignment = result.count("input") ? adapter::readCompressedAssignment(
             result["input"].as<std::string>(),
             num_rows,
             num_cols,
             input_config.num_elements
-        ) : ldg::createAssignment(data.size());
+        ) : ldg::createAssignment(num_rows * num_cols);
 
         return {
-            data,
+            std::move(data),
             assignment,
             input_config.grid_dims,
             std::ceil(std::log2(std::max(num_rows, num_cols))) + 1,
@@ -107,6 +166,24 @@ namespace program
         };
     }
 
+    /**
+     * Load the memory layout of the quad tree from the input arguments. Falls back to the row-major layout if the requested
+     * layout is not supported for the grid dimensions.
+     *
+     * @param result
+     * @param dims
+     * @return
+     */
+    ldg::LayoutType loadLayoutFromInput(cxxopts::ParseResult const &result, std::pair<size_t, size_t> dims)
+    {
+        auto layout = static_cast<ldg::LayoutType>(result["layout"].as<size_t>());
+        if (!ldg::supportsLayout(layout, dims.first, dims.second)) {
+            std::cerr << "Warning: The layout is not supported for a " << dims.first << "x" << dims.second << " grid, using the row-major layout instead.\n";
+            return ldg::LayoutType::ROW_MAJOR;
+        }
+        return layout;
+    }
+
     /**
      * Load the schedule data from the input arguments.
      * Exits if arguments are invalid or missing.
@@ -127,19 +204,38 @@ namespace program
      * Load the sort options data from the input arguments.
      * Exits if arguments are invalid or missing.
      *
-     * @tparam VectorType
+     * @tparam DistanceFunction The functor selected by the distance function type of the input.
      * @param result
      * @return
      */
-    template<typename VectorType>
-    program::SortOptions<VectorType> loadSortOptionsFromInput(cxxopts::ParseResult const &result)
+    template<typename DistanceFunction>
+    program::SortOptions<DistanceFunction> loadSortOptionsFromInput(cxxopts::ParseResult const &result)
     {
+        size_t exchange_group_len = result["exchange_group_len"].as<size_t>();
+        if (exchange_group_len < 2 || exchange_group_len > ssm::MAX_EXCHANGE_GROUP_LEN) {
+            std::cerr << "Exchange group length must be between 2 and " << ssm::MAX_EXCHANGE_GROUP_LEN << ". Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        size_t neighbourhood_len = result["neighbourhood_len"].as<size_t>();
+        if (neighbourhood_len < 3) {   // Smaller neighbourhoods leave the windows of some partitions empty
+            std::cerr << "Neighbourhood length must be at least 3. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (result["subtree_exchanges"].as<bool>() && !result["ssm_mode"].as<bool>()) {   // The own parent of a partition is always its best target
+            std::cerr << "Subtree exchanges require the SSM mode, as the highest parent hierarchy target always keeps partitions in place. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
         return {
             result["max_iterations"].as<size_t>(),
             result["min_distance_change"].as<double>(),
-            ldg::mapFunctionTypeToFunction<VectorType>(static_cast<ldg::DistanceFunctionType>(result["distance_function"].as<size_t>())),
+            DistanceFunction{},
             result["randomize"].as<bool>(),
-            result["ssm_mode"].as<bool>()
+            result["ssm_mode"].as<bool>(),
+            exchange_group_len,
+            result["subtree_exchanges"].as<bool>(),
+            result["skip_inactive"].as<bool>(),
+            neighbourhood_len
         };
     }
 
@@ -165,6 +261,7 @@ namespace program
             result["debug"].as<bool>(),
             !result["log_only"].as<bool>() && result["export"].as<bool>(),
             !result["log_only"].as<bool>() && result["visualization_config"].as<std::string>().empty() && result["export"].as<bool>(),
+            {}  // full_resolution_export
         };
     }
 };
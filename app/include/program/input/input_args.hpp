@@ -21,6 +21,7 @@ namespace program
            ("config", "Path to the config file.", cxxopts::value<std::string>())
            ("input", "Path to the previous assignment file.", cxxopts::value<std::string>())
            ("output", "Path to the output directory.", cxxopts::value<std::string>()->default_value("./"))
+           ("memory_map", "Memory-map the input data read-only instead of loading it into memory. Compressed data is decompressed into a cache next to it. Requires the data type to match the type of the input data.", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
            // Method parameters
            ("cores", "Number of cores to use for parallel operations.", cxxopts::value<size_t>())
            ("passes", "Number of passes.", cxxopts::value<size_t>()->default_value("1"))
@@ -31,8 +32,17 @@ namespace program
            ("seed", "Randomization seed.", cxxopts::value<size_t>()->default_value(std::to_string(std::time(0))))
            ("randomize", "Randomize the assignment at the start.", cxxopts::value<bool>()->default_value("true")->implicit_value("true"))
            ("parent_type", "Type of parent representation to use. Options are: Normalized average: 0, Minimum child: 1", cxxopts::value<size_t>()->default_value("0"))
-           ("distance_function", "Distance function to use. Options are: Euclidean distance: 0, Cosine Similarity: 1", cxxopts::value<size_t>()->default_value("0"))
+           ("distance_function", "Distance function to use. Options are: Euclidean distance: 0, Cosine Similarity: 1, Squared Euclidean distance: 2, Manhattan distance: 3, Chebyshev distance: 4", cxxopts::value<size_t>()->default_value("0"))
+           ("data_type", "Data type used for storage and distance computations. Options are: Double: 0, Float: 1, Unsigned byte: 2, Unsigned short: 3. Defaults to the type of the input data.", cxxopts::value<size_t>())
+           ("reduction", "Sort on reduced features of the data, while exports keep using the full-resolution data. Options are: None: 0, PCA: 1, Random projection: 2", cxxopts::value<size_t>()->default_value("0"))
+           ("reduced_dims", "Number of dimensions of the reduced sorting features.", cxxopts::value<size_t>()->default_value("32"))
+           ("normalize", "Sort on data elements scaled to unit length, such that averaged parents are averages of directions. Only with the cosine distance, for floating point data loaded into memory. Exports keep the original data.", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+           ("layout", "Memory layout of the quad tree. Options are: Row-major: 0, Z-order: 1 (only for grids with power of two dimensions)", cxxopts::value<size_t>()->default_value("0"))
            ("ssm_mode", "Whether the sorting should mimic the Self-Sorting Map (SSM). This changes some parameters like the start sorting height, the target function and cell pairings.", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+           ("exchange_group_len", "Number of partitions per dimension of an exchange block. Blocks of more than 2x2 partitions are solved as a linear assignment problem.", cxxopts::value<size_t>()->default_value("2"))
+           ("subtree_exchanges", "Exchange whole partitions as subtrees before exchanging their cells. Only with --ssm_mode, as the own parent of a partition is its target otherwise.", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+           ("skip_inactive", "Only compare the exchange blocks of which the cells or targets changed since they were last compared.", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+           ("neighbourhood_len", "Number of partitions per dimension of the neighbourhood that the partition targets are averaged over.", cxxopts::value<size_t>()->default_value("4"))
            // Debug parameters
            ("debug", "Enable debugging (use synthetic data).", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
            ("rows", "Number of rows of the grid.", cxxopts::value<size_t>()->default_value("128"))
@@ -9,6 +9,7 @@
 #include <nlohmann/json.hpp>
 
 #include "input_type.hpp"
+#include "data_type.hpp"
 
 using JSON = nlohmann::json;
 
@@ -24,6 +25,7 @@ namespace program
         std::string data_path;
         std::pair<size_t, size_t> grid_dims;
         std::array<size_t, 3> data_dims;
+        DataType data_type = DataType::FLOAT64;
 
         void fromJSONFile(std::string file_name);
         void toJSONFile(std::string file_name);
@@ -36,6 +38,7 @@ namespace program
         const std::string KEYWORD_DATA = "data";
         const std::string KEYWORD_PATH = "path";
         const std::string KEYWORD_LENGTH = "length";
+        const std::string KEYWORD_DATA_TYPE = "dtype";
         const std::string KEYWORD_DIMENSIONS = "dimensions";
         const std::string KEYWORD_X = "x";
         const std::string KEYWORD_Y = "y";
@@ -55,6 +58,9 @@ namespace program
         type = new_type == "data" ? InputType::DATA : InputType::VISUALIZATION;
         num_elements = parsed[KEYWORD_DATA][KEYWORD_LENGTH];
         data_path = parsed[KEYWORD_DATA][KEYWORD_PATH];
+        data_type = parsed[KEYWORD_DATA].contains(KEYWORD_DATA_TYPE) ?
+            mapStringToDataType(parsed[KEYWORD_DATA][KEYWORD_DATA_TYPE]) :
+            DataType::FLOAT64;  // Older configs are always doubles
 
         size_t x = parsed[KEYWORD_GRID][KEYWORD_ROWS];
         size_t y = parsed[KEYWORD_GRID][KEYWORD_COLUMNS];
@@ -80,6 +86,7 @@ namespace program
 
         json[KEYWORD_DATA][KEYWORD_LENGTH] = num_elements;
         json[KEYWORD_DATA][KEYWORD_PATH] = data_path;
+        json[KEYWORD_DATA][KEYWORD_DATA_TYPE] = mapDataTypeToString(data_type);
 
         json[KEYWORD_DATA][KEYWORD_DIMENSIONS][KEYWORD_X] = data_dims[0];
         json[KEYWORD_DATA][KEYWORD_DIMENSIONS][KEYWORD_Y] = data_dims[1];
@@ -19,13 +19,14 @@ namespace program
      * Note that we assume everything has been initialized from the input at this point, and we only do a couple of sanity checks before proceeding.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param schedule
      * @param sort_options
      * @param export_settings
      */
-    template<typename VectorType>
-    void run(ldg::QuadAssignmentTree<VectorType> &quad_tree, Schedule &schedule, SortOptions<VectorType> &sort_options, ExportSettings &export_settings)
+    template<typename VectorType, typename DistanceFunction>
+    void run(ldg::QuadAssignmentTree<VectorType> &quad_tree, Schedule &schedule, SortOptions<DistanceFunction> &sort_options, ExportSettings &export_settings)
     {
         ldg::assertUniqueAssignment(quad_tree);
         std::cout << "Initial HND: " << ldg::computeHierarchyNeighborhoodDistance(0, sort_options.distance_function, quad_tree) << std::endl;
@@ -61,6 +62,10 @@ namespace program
                 max_iterations,
                 distance_threshold,
                 sort_options.ssm_mode,
+                sort_options.exchange_group_len,
+                sort_options.subtree_exchanges,
+                sort_options.skip_inactive,
+                sort_options.neighbourhood_len,
                 logger,
                 export_settings
             );
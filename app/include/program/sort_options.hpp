@@ -4,7 +4,6 @@
 #include "app/include/self_sorting_map/target/target_type.hpp"
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 
-#include <functional>
 #include <memory>
 #include <string>
 
@@ -12,17 +11,21 @@ namespace program
 {
     /**
      * Options that should be used for sorting. These essentially serve as input for ssm::sort next to the data
-     * @tparam VectorType
+     * @tparam DistanceFunction
      */
-    template<typename VectorType>
+    template<typename DistanceFunction>
     struct SortOptions
     {
         size_t max_iterations;              // Maximum number of iterations before the SSM should move to the next height.
         double distance_threshold;          // Minimum ratio of distance that should be changed before the SSM should move to the next height.
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function;
+        DistanceFunction distance_function;
 
         bool randomize_assignment;
         bool ssm_mode;
+        size_t exchange_group_len;          // Number of partitions per dimension of an exchange block.
+        bool subtree_exchanges;             // Whether whole partitions should be exchanged before exchanging their cells.
+        bool skip_inactive;                 // Whether blocks of which the cells and targets did not change should be skipped.
+        size_t neighbourhood_len;           // Number of partitions per dimension of the partition neighbourhood target.
     };
 }
 
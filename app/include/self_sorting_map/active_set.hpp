@@ -0,0 +1,112 @@
+#ifndef LDG_CORE_ACTIVE_SET_HPP
+#define LDG_CORE_ACTIVE_SET_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "app/include/ldg/model/cell_position.hpp"
+#include "app/include/self_sorting_map/target/partition_neighbourhood_target.hpp"
+
+namespace ssm
+{
+    /**
+     * Tracks which partitions at a height changed since the exchanges of each configuration (regular and shifted) last compared
+     * them. Exchange blocks of which neither the cells nor the targets changed since then are skipped.
+     */
+    class ActiveSet
+    {
+        size_t height;
+        long num_rows;  // Number of partitions per dimension.
+        long num_cols;
+        long radius;    // Number of partitions in each direction that targets are aggregated from.
+        std::array<std::vector<uint8_t>, 2> changed;    // Per configuration, the partitions that changed since it last ran.
+
+    public:
+        ActiveSet(size_t height, std::pair<size_t, size_t> const &dims, size_t neighbourhood_len);
+
+        void markChanged(size_t row, size_t col);
+
+        void markAllChanged();
+
+        std::vector<long> takeActiveBlocks(bool apply_shift, long group_len, long shift_len, long num_block_rows, long num_block_cols);
+    };
+
+    /**
+     * Create an active set in which all partitions are changed.
+     *
+     * @param height    Height of the partitions.
+     * @param dims  Number of [rows, columns] of partitions at the height.
+     * @param neighbourhood_len Number of partitions per dimension of the partition neighbourhood.
+     */
+    inline ActiveSet::ActiveSet(size_t height, std::pair<size_t, size_t> const &dims, size_t neighbourhood_len):
+        height(height),
+        num_rows(static_cast<long>(dims.first)),
+        num_cols(static_cast<long>(dims.second)),
+        radius(getPartitionNeighbourhoodRadius(neighbourhood_len)),
+        changed{ std::vector<uint8_t>(dims.first * dims.second, 1), std::vector<uint8_t>(dims.first * dims.second, 1) }
+    {}
+
+    /**
+     * Mark the partition containing a leaf as changed for both configurations. This is safe to call concurrently.
+     *
+     * @param row   Row of the leaf.
+     * @param col   Column of the leaf.
+     */
+    inline void ActiveSet::markChanged(size_t row, size_t col)
+    {
+        size_t partition = ldg::rowMajorIndex(row >> height, col >> height, num_cols);
+        for (auto &configuration_changed : changed)
+            std::atomic_ref(configuration_changed[partition]).store(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Mark all partitions as changed, for example after whole partitions were moved.
+     */
+    inline void ActiveSet::markAllChanged()
+    {
+        for (auto &configuration_changed : changed)
+            std::fill(configuration_changed.begin(), configuration_changed.end(), 1);
+    }
+
+    /**
+     * Collect the exchange blocks of a configuration that have to be compared, after which its changes are cleared.
+     * A block is active if one of its partitions changed, or if a partition changed that the targets of its partitions are
+     * aggregated from. Targets never reach further than the partition neighbourhood.
+     *
+     * @param apply_shift   Whether this is the shifted configuration.
+     * @param group_len Number of partitions per dimension of an exchange block.
+     * @param shift_len Number of partitions the exchange blocks are shifted back by.
+     * @param num_block_rows
+     * @param num_block_cols
+     * @return The row-major indices of the active blocks in ascending order.
+     */
+    inline std::vector<long> ActiveSet::takeActiveBlocks(bool apply_shift, long group_len, long shift_len, long num_block_rows, long num_block_cols)
+    {
+        auto &configuration_changed = changed[apply_shift ? 1 : 0];
+
+        std::vector<uint8_t> is_active(num_block_rows * num_block_cols, 0);
+#pragma omp parallel for schedule(static)
+        for (long block = 0; block < num_block_rows * num_block_cols; ++block) {
+            long min_y = std::max((block / num_block_cols) * group_len - shift_len - radius, long(0));
+            long max_y = std::min((block / num_block_cols) * group_len - shift_len + group_len + radius, num_rows);
+            long min_x = std::max((block % num_block_cols) * group_len - shift_len - radius, long(0));
+            long max_x = std::min((block % num_block_cols) * group_len - shift_len + group_len + radius, num_cols);
+            for (long y = min_y; y < max_y && !is_active[block]; ++y) {
+                for (long x = min_x; x < max_x && !is_active[block]; ++x)
+                    is_active[block] = configuration_changed[ldg::rowMajorIndex(y, x, num_cols)];
+            }
+        }
+
+        std::vector<long> active_blocks;
+        for (long block = 0; block < num_block_rows * num_block_cols; ++block) {
+            if (is_active[block])
+                active_blocks.push_back(block);
+        }
+        std::fill(configuration_changed.begin(), configuration_changed.end(), 0);
+        return active_blocks;
+    }
+}
+
+#endif //LDG_CORE_ACTIVE_SET_HPP
@@ -1,93 +1,242 @@
 #ifndef LDG_CORE_EXCHANGES_HPP
 #define LDG_CORE_EXCHANGES_HPP
 
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <limits>
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/self_sorting_map/permutations.hpp"
+#include "app/include/self_sorting_map/target_distances.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
 
 namespace ssm
 {
     /**
-     * Compare nodes and find the permutation which minimizes the distance to all targets.
-     * Afterwards, exchange all items into this permutation.
+     * Compute the summed distance of a data item to all targets of a partition. The computation is abandoned once the distance
+     * exceeds the bound, using bounded distance functions to also stop accumulating over the elements.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param value
+     * @param target_table
+     * @param partition
+     * @param distance_function
+     * @param bound
+     * @return The distance, or infinity if it exceeds the bound.
+     */
+    template<typename VectorType, typename DistanceFunction>
+    double computeTargetsCost(
+        ldg::VectorView<VectorType> value,
+        TargetTable<VectorType> const &target_table,
+        size_t partition,
+        DistanceFunction &distance_function,
+        double bound
+    )
+    {
+        using namespace ldg;
+        double distance = 0.;
+        for (size_t target_idx = 0; target_idx < target_table.getNumTargets(partition); ++target_idx) {
+            auto target = target_table.getTarget(partition, target_idx);
+            if constexpr (BoundedDistance<DistanceFunction, VectorType>) {
+                distance += distance_function(value, target, bound - distance);
+            } else {
+                distance += distance_function(value, target);
+            }
+            if (distance > bound)
+                return std::numeric_limits<double>::infinity();
+        }
+        return distance;
+    }
+
+    /**
+     * Fill the cost of placing the data of every node at the position of every node.
+     * The cost of keeping all nodes in place is computed first, since any cost above it can never be part of a better permutation.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param num_nodes
+     * @param node_data Data per node.
+     * @param target_table
+     * @param node_partitions   Partition of the targets per node position.
+     * @param distance_function
+     * @return
+     */
+    template<typename VectorType, typename DistanceFunction>
+    CostMatrix computeCostMatrix(
+        size_t num_nodes,
+        std::array<ldg::VectorView<VectorType>, MAX_EXCHANGE_NODES> const &node_data,
+        TargetTable<VectorType> const &target_table,
+        std::array<size_t, MAX_EXCHANGE_NODES> const &node_partitions,
+        DistanceFunction &distance_function
+    )
+    {
+        CostMatrix costs{};
+        double identity_distance = 0.;
+        for (size_t idx = 0; idx < num_nodes; ++idx) {
+            costs[idx][idx] = computeTargetsCost(node_data[idx], target_table, node_partitions[idx], distance_function, std::numeric_limits<double>::infinity());
+            identity_distance += costs[idx][idx];
+        }
+
+        // Abandoned costs are replaced by a finite cost above the bound, which keeps them out of any better permutation while
+        // allowing larger groups to be solved as an assignment problem.
+        double abandoned_distance = 2. * identity_distance + 1.;
+        for (size_t position = 0; position < num_nodes; ++position) {
+            for (size_t node = 0; node < num_nodes; ++node) {
+                if (node != position) {
+                    double cost = computeTargetsCost(node_data[node], target_table, node_partitions[position], distance_function, identity_distance);
+                    costs[node][position] = std::min(cost, abandoned_distance);
+                }
+            }
+        }
+        return costs;
+    }
+
+    /**
+     * Exchange the assignments of leaves into a permutation.
      *
      * @tparam VectorType
      * @param nodes
      * @param quad_tree
+     * @param permutation
+     * @param node_assignments  Assignment per leaf before the exchange.
+     * @return The number of exchanges performed.
+     */
+    template<typename VectorType>
+    size_t swapLeafAssignments(
+        std::vector<ldg::CellPosition> const &nodes,
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        Permutation const &permutation,
+        std::array<size_t, MAX_EXCHANGE_NODES> const &node_assignments
+    )
+    {
+        size_t exchanges_count = 0;
+        for (size_t idx = 0; idx < nodes.size(); ++idx) {
+            if (permutation[idx] != idx) {
+                quad_tree.setAssignmentValue(nodes[idx], node_assignments[permutation[idx]]);
+                ++exchanges_count;
+            }
+        }
+        return exchanges_count;
+    }
+
+    /**
+     * Compare subtrees and find the permutation which minimizes the distance of their values to all targets.
+     * Rather than moving the leaves, the permutation is applied to the sources in the partition table of the quad tree, which
+     * moves every subtree in O(1).
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param nodes Partitions at the height of the partition table.
+     * @param quad_tree
      * @param distance_function
-     * @param target_map
+     * @param target_table
      * @return The number of exchanges performed.
     */
-    template<typename VectorType>
-    size_t findAndSwapBestPermutation(
+    template<typename VectorType, typename DistanceFunction>
+    size_t findAndSwapBestSubtreePermutation(
         std::vector<ldg::CellPosition> &nodes,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
-        std::vector<std::vector<std::shared_ptr<VectorType>>> &target_map
+        DistanceFunction distance_function,
+        TargetTable<VectorType> const &target_table
     )
     {
         using namespace ldg;
-        // Precheck if all partitions are of the same size, since this is a requirement for swapping.
+        // Precheck if all partitions are of the same shape, since this is a requirement for swapping.
         size_t num_nodes = nodes.size();
-        size_t num_leaves = 0;
+        std::array<VectorView<VectorType>, MAX_EXCHANGE_NODES> node_data;
+        std::array<size_t, MAX_EXCHANGE_NODES> node_partitions{};
+        std::array<size_t, MAX_EXCHANGE_NODES> node_sources{};
         for (size_t idx = 0; idx < num_nodes; ++idx) {
-            auto dims = quad_tree.getLeafBounds(nodes[idx]).second;
-            size_t node_num_leaves = dims.first * dims.second;
-            if (num_leaves == 0) {
-                num_leaves = node_num_leaves;
-            } else if (node_num_leaves != num_leaves) {
+            if (quad_tree.getLeafBounds(nodes[idx]).second != quad_tree.getLeafBounds(nodes[0]).second)
                 return 0;
-            }
-        }
 
-        // Preload data and assignments
-        std::vector<std::vector<size_t>> node_assignments(num_nodes);   // Assigned indices per node
-        std::vector<std::shared_ptr<VectorType>> node_data(num_nodes);  // Actual data per node
-        for (size_t idx = 0; idx < num_nodes; ++idx) {
             node_data[idx] = quad_tree.getValue(nodes[idx]);
-            auto leaf_iterator = (TreeWalker<VectorType>(nodes[idx], quad_tree)).getLeaves();
-            node_assignments[idx].reserve(num_leaves);
-            for (; leaf_iterator != leaf_iterator.end(); ++leaf_iterator)
-                node_assignments[idx].push_back(quad_tree.getAssignmentValue(leaf_iterator.getPosition()));
+            node_partitions[idx] = nodes[idx].index;
+            node_sources[idx] = quad_tree.getPartitionSource(nodes[idx].index);
         }
 
-        // Find best permutation
-        double minimum_distance = -1.; // We assume the distance to always be positive, so this flags this to uninitialized.
-        std::vector<size_t> best_permutation(num_nodes);
-        for (size_t idx = 0; idx < num_nodes; ++idx)
-            best_permutation[idx] = idx;
-        std::vector permutation(best_permutation);
+        auto best_permutation = findBestPermutation(computeCostMatrix(num_nodes, node_data, target_table, node_partitions, distance_function), num_nodes);
 
-        do {
-            double distance = 0.;
-            for (size_t idx = 0; idx < num_nodes; ++idx) {
-                for (auto &target : target_map[nodes[idx].index]) {
-                    distance += distance_function(
-                        node_data[permutation[idx]],
-                        target
-                    );
-                }
-            }
-
-            // Better permutation, save it
-            if (minimum_distance == -1 || minimum_distance > distance) {
-                minimum_distance = distance;
-                best_permutation = permutation;
-            }
-        } while (std::next_permutation(permutation.begin(), permutation.end()));
-
-        // Perform the actual exchanges where needed
         size_t exchanges_count = 0;
         for (size_t idx = 0; idx < num_nodes; ++idx) {
             if (best_permutation[idx] != idx) {
-                auto leaf_iterator = (TreeWalker<VectorType>(nodes[idx], quad_tree)).getLeaves();
-                for (size_t leaf_idx = 0; leaf_iterator != leaf_iterator.end(); ++leaf_iterator, ++leaf_idx)
-                    quad_tree.setAssignmentValue(leaf_iterator.getPosition(), node_assignments[best_permutation[idx]][leaf_idx]);
+                quad_tree.setPartitionSource(nodes[idx].index, node_sources[best_permutation[idx]]);
                 ++exchanges_count;
             }
         }
 
         return exchanges_count;
     }
+
+    /**
+     * Compare leaves and find the permutation which minimizes the distance to all targets.
+     * Afterwards, exchange all items into this permutation.
+     * Since every leaf holds a single assignment, the assignments are read and written directly without any allocations.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param nodes Leaves within the same exchange block.
+     * @param quad_tree
+     * @param distance_function
+     * @param target_table
+     * @return The number of exchanges performed.
+     */
+    template<typename VectorType, typename DistanceFunction>
+    size_t findAndSwapBestLeafPermutation(
+        std::vector<ldg::CellPosition> &nodes,
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        DistanceFunction distance_function,
+        TargetTable<VectorType> const &target_table
+    )
+    {
+        size_t num_nodes = nodes.size();
+        std::array<size_t, MAX_EXCHANGE_NODES> node_assignments{};
+        std::array<ldg::VectorView<VectorType>, MAX_EXCHANGE_NODES> node_data;
+        std::array<size_t, MAX_EXCHANGE_NODES> node_partitions{};
+        for (size_t idx = 0; idx < num_nodes; ++idx) {
+            node_assignments[idx] = quad_tree.getAssignmentValue(nodes[idx]);
+            node_data[idx] = quad_tree.getValue(nodes[idx]);
+            node_partitions[idx] = target_table.getPartition(nodes[idx].index);
+        }
+
+        auto best_permutation = findBestPermutation(computeCostMatrix(num_nodes, node_data, target_table, node_partitions, distance_function), num_nodes);
+        return swapLeafAssignments(nodes, quad_tree, best_permutation, node_assignments);
+    }
+
+    /**
+     * Compare leaves and find the permutation which minimizes the distance to all targets, reading the cost matrix from
+     * precomputed target distances. Afterwards, exchange all items into this permutation.
+     *
+     * @tparam VectorType
+     * @param nodes Leaves within the same exchange block.
+     * @param slots Slot of the partition of every node within the exchange block.
+     * @param quad_tree
+     * @param target_distances
+     * @param exchange  Index of the exchange in the target distances.
+     * @return The number of exchanges performed.
+     */
+    template<typename VectorType>
+    size_t findAndSwapBestPermutation(
+        std::vector<ldg::CellPosition> &nodes,
+        std::vector<int> const &slots,
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        TargetDistances const &target_distances,
+        long exchange
+    )
+    {
+        size_t num_nodes = nodes.size();
+        std::array<size_t, MAX_EXCHANGE_NODES> node_assignments{};
+        CostMatrix costs{};
+        for (size_t node = 0; node < num_nodes; ++node) {
+            node_assignments[node] = quad_tree.getAssignmentValue(nodes[node]);
+            for (size_t position = 0; position < num_nodes; ++position)
+                costs[node][position] = target_distances(exchange, slots[node], slots[position]);
+        }
+
+        auto best_permutation = findBestPermutation(costs, num_nodes);
+        return swapLeafAssignments(nodes, quad_tree, best_permutation, node_assignments);
+    }
 }
 
 #endif //LDG_CORE_EXCHANGES_HPP
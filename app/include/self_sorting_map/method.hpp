@@ -52,23 +52,32 @@ namespace ssm
      * specifically for a QuadAssignmentTree given a distance function.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param distance_function
      * @param iterations_between_checkpoint
      * @param max_iterations
      * @param distance_threshold
      * @param ssm_mode
+     * @param exchange_group_len   Number of partitions per dimension of an exchange block.
+     * @param subtree_exchanges    Whether whole partitions should be exchanged before exchanging their cells.
+     * @param skip_inactive    Whether exchange blocks of which the cells and targets did not change since they were last compared should be skipped.
+     * @param neighbourhood_len    Number of partitions per dimension of the partition neighbourhood target.
      * @param logger
      * @param export_settings
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     void sort(
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
         const size_t iterations_between_checkpoint,
         const size_t max_iterations,
         const double distance_threshold,
         const bool ssm_mode,
+        const size_t exchange_group_len,
+        const bool subtree_exchanges,
+        const bool skip_inactive,
+        const size_t neighbourhood_len,
         program::Logger &logger,
         program::ExportSettings &export_settings
     ) {
@@ -79,15 +88,19 @@ namespace ssm
         // Main loop
         size_t num_exchanges;
         std::string reason;
+        TargetCache<VectorType> target_cache;   // Reused by all iterations, such that only targets of changed parents are reloaded
+        TargetDistances target_distances;   // Reused by all passes and heights, such that it is only allocated once
 
         for (size_t height = ssm_mode ? getSSMStartHeight(quad_tree) : quad_tree.getDepth() - 2; height > 0; --height) {
             size_t iterations = 0;
+            ActiveSet active_set(height, quad_tree.getBounds(height).second, neighbourhood_len);
+            ActiveSet *active_set_ptr = skip_inactive ? &active_set : nullptr;
 
             do {
                 num_exchanges = 0;
-                num_exchanges += optimizePartitions(quad_tree, distance_function, height, ssm_mode, false);
+                num_exchanges += optimizePartitions(quad_tree, distance_function, target_cache, height, ssm_mode, exchange_group_len, subtree_exchanges, neighbourhood_len, active_set_ptr, target_distances, false);
                 if (height < quad_tree.getDepth() - 2)
-                    num_exchanges += optimizePartitions(quad_tree, distance_function, height, ssm_mode, true);
+                    num_exchanges += optimizePartitions(quad_tree, distance_function, target_cache, height, ssm_mode, exchange_group_len, subtree_exchanges, neighbourhood_len, active_set_ptr, target_distances, true);
 
                 distance = new_distance;
                 new_distance = computeHierarchyNeighborhoodDistance(0, distance_function, quad_tree);
@@ -1,10 +1,15 @@
 #ifndef LDG_CORE_PARTITIONS_HPP
 #define LDG_CORE_PARTITIONS_HPP
 
+#include <algorithm>
 #include <functional>
+#include <numeric>
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 #include "app/include/self_sorting_map/target/target_type.hpp"
+#include "app/include/self_sorting_map/active_set.hpp"
 #include "app/include/self_sorting_map/exchanges.hpp"
+#include "app/include/self_sorting_map/target_cache.hpp"
+#include "app/include/adapter/tile_scheduler.hpp"
 
 namespace ssm
 {
@@ -14,22 +19,18 @@ namespace ssm
      * If not, randomize the pairings to avoid local minima through bad pairings.
      *
      * @param num_elements
+     * @param num_partitions    Number of partitions in an exchange block.
      * @param randomize
      * @return
      */
-    std::array<std::vector<long>, 4> generateCellPairings(size_t num_elements, bool randomize)
+    std::vector<std::vector<long>> generateCellPairings(size_t num_elements, size_t num_partitions, bool randomize)
     {
         // Create maps per element
         std::vector<long> map(num_elements);
         std::iota(map.begin(), map.end(), 0);
 
-        // Copy simple ranges into array
-        std::array<std::vector<long>, 4> pair_array{
-            map,
-            map,
-            map,
-            map
-        };
+        // Copy simple ranges per partition
+        std::vector<std::vector<long>> pair_array(num_partitions, map);
 
         // Shuffle all elements if not in SSM mode
         if (randomize) {
@@ -44,27 +45,39 @@ namespace ssm
     /**
      * Perform the exchanges of the self-sorting map. This functions handles pairing up the right data and then getting it compared.
      * This functions goes over the data without the use of the fancy iterators to allow easy element-wise comparisons for better
-     * parallelization. Additionally, this iterates in a row-major fashion which results in better data reading.
+     * parallelization. Additionally, this iterates block by block, which results in better data reading.
+     * If an active set is given, only the blocks in which the cells or targets changed since they were last compared are iterated.
+     * If the data is mapped from a file, the rows of partitions are processed band by band, such that only the bands being
+     * exchanged have to be resident.
+     * Otherwise, the distances of the elements to their targets are computed as matrix products if the data and distance
+     * function allow it, for a chunk of exchanges at a time.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param distance_function
-     * @param target_map
+     * @param target_table
      * @param cell_pairings_array
      * @param partition_len Length of the current partition.
+     * @param group_len Number of partitions per dimension of an exchange block.
      * @param offset    Offset [rows, columns] for the calculated indices. This is used to project back to actual array indices
      * @param iteration_dims    The dimensions to be iterated over.
+     * @param active_set    Changed partitions to limit the exchanges to, or nullptr to compare all blocks.
+     * @param target_distances  Storage for the distances of the elements to their targets, which is reused between calls.
      * @return
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     size_t performPartitionExchanges(
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
-        std::vector<std::vector<std::shared_ptr<VectorType>>> &target_map,
-        std::array<std::vector<long>, 4> &cell_pairings_array,
+        DistanceFunction distance_function,
+        TargetTable<VectorType> &target_table,
+        std::vector<std::vector<long>> &cell_pairings_array,
         const long partition_len,
+        const long group_len,
         std::pair<long, long> &offset,
-        std::pair<long, long> &iteration_dims
+        std::pair<long, long> &iteration_dims,
+        ActiveSet *active_set,
+        TargetDistances &target_distances
     ) {
         using namespace ldg;
 
@@ -72,44 +85,152 @@ namespace ssm
         auto [comparison_num_rows, comparison_num_cols] = quad_tree.getBounds(0).second;
         auto [offset_y, offset_x] = offset;
 
-        long projected_num_rows = iteration_num_rows / 2 + (iteration_num_rows % (2 * partition_len)) % partition_len;
-        long projected_num_cols = iteration_num_cols / 2 + (iteration_num_cols % (2 * partition_len)) % partition_len;
-        long num_elems = projected_num_rows * projected_num_cols;
+        // Every exchange block is projected onto a single partition, of which each cell pairs up a cell of all its partitions.
+        long block_len = group_len * partition_len;
+        long block_num_elems = partition_len * partition_len;
+        long num_block_rows = (iteration_num_rows + block_len - 1) / block_len;
+        long num_block_cols = (iteration_num_cols + block_len - 1) / block_len;
 
-        std::vector<CellPosition> nodes;
-        nodes.reserve(4);
+        // Compact the blocks to compare into a work list
+        std::vector<long> blocks;
+        if (active_set != nullptr) {
+            blocks = active_set->takeActiveBlocks(offset_y < 0, group_len, -offset_y / partition_len, num_block_rows, num_block_cols);
+        } else {
+            blocks.resize(num_block_rows * num_block_cols);
+            std::iota(blocks.begin(), blocks.end(), 0);
+        }
+
+        // Exchange idx pairs up a cell of every partition of block blocks[idx / block_num_elems]
+        auto exchange_range = [&](long start_exchange, long end_exchange, auto &&find_and_swap) {
+            std::vector<CellPosition> nodes;
+            std::vector<int> slots;
+            nodes.reserve(group_len * group_len);
+            slots.reserve(group_len * group_len);
+            size_t num_exchanges = 0;
+
+#pragma omp parallel for private(nodes, slots) reduction(+:num_exchanges) schedule(static)
+            for (long idx = start_exchange; idx < end_exchange; ++idx) {
+                long block = blocks[idx / block_num_elems];
+                long within_partition_index = idx % block_num_elems;
+
+                long base_x = offset_x + (block % num_block_cols) * block_len;
+                long base_y = offset_y + (block / num_block_cols) * block_len;
+
+                // Pair nodes and perform exchanges
+                nodes.clear();
+                slots.clear();
+                long count = 0;   // Use a count to adjust for selecting the neighbouring partitions
+                for (auto &cell_pairings : cell_pairings_array) {
+                    long pair_index = cell_pairings[within_partition_index];
+                    long pair_x = base_x + pair_index % partition_len + (count % group_len) * partition_len;
+                    long pair_y = base_y + pair_index / partition_len + (count / group_len) * partition_len;
+
+                    // Check if this node is within range
+                    if (pair_x >= 0 && pair_x < comparison_num_cols && pair_y >= 0 && pair_y < comparison_num_rows) {
+                        nodes.push_back(ldg::CellPosition{ 0, ldg::rowMajorIndex(pair_y, pair_x, comparison_num_cols) });
+                        slots.push_back(static_cast<int>(count));
+                    }
+                    ++count;
+                }
+                size_t node_exchanges = nodes.size() > 1 ? find_and_swap(nodes, slots, idx) : 0;
+                if (node_exchanges > 0 && active_set != nullptr) {
+                    for (auto &node : nodes)
+                        active_set->markChanged(node.index / comparison_num_cols, node.index % comparison_num_cols);
+                }
+                num_exchanges += node_exchanges;
+            }
+
+            return num_exchanges;
+        };
+
+        auto find_and_swap = [&](std::vector<CellPosition> &nodes, std::vector<int> const &, long) {
+            return findAndSwapBestLeafPermutation(nodes, quad_tree, distance_function, target_table);
+        };
+
+        auto num_blocks = static_cast<long>(blocks.size());
+        adapter::TileScheduler scheduler(quad_tree);
+        if (!scheduler.isActive()) {
+            if constexpr (supportsTargetDistances<VectorType, DistanceFunction>()) {
+                // The exchanges of a chunk only read the distances of their own elements, so the chunks can be computed one by one
+                long chunk_len = getTargetDistancesChunkLen(group_len);
+                size_t num_exchanges = 0;
+                for (long start_exchange = 0; start_exchange < num_blocks * block_num_elems; start_exchange += chunk_len) {
+                    long end_exchange = std::min(start_exchange + chunk_len, num_blocks * block_num_elems);
+                    computeTargetDistances(target_distances, quad_tree, distance_function, target_table, cell_pairings_array, blocks, partition_len, group_len, offset, num_block_cols, start_exchange, end_exchange);
+                    num_exchanges += exchange_range(start_exchange, end_exchange, [&](std::vector<CellPosition> &nodes, std::vector<int> const &slots, long exchange) {
+                        return findAndSwapBestPermutation(nodes, slots, quad_tree, target_distances, exchange);
+                    });
+                }
+                return num_exchanges;
+            }
+            return exchange_range(0, num_blocks * block_num_elems, find_and_swap);
+        }
+
+        // Each band covers one row of exchange blocks, which spans group_len * partition_len rows of the grid.
+        long band_num_rows = block_len;
         size_t num_exchanges = 0;
+        scheduler.prefetch(offset_y, offset_y + band_num_rows);
+        for (long band = 0; band < num_block_rows; ++band) {
+            long band_start_row = offset_y + band * band_num_rows;
+            scheduler.prefetch(band_start_row + band_num_rows, band_start_row + 2 * band_num_rows);
+            scheduler.cacheNorms(band_start_row, band_start_row + band_num_rows);
+            long start_block = std::lower_bound(blocks.begin(), blocks.end(), band * num_block_cols) - blocks.begin();
+            long end_block = std::lower_bound(blocks.begin(), blocks.end(), (band + 1) * num_block_cols) - blocks.begin();
+            num_exchanges += exchange_range(start_block * block_num_elems, end_block * block_num_elems, find_and_swap);
+            scheduler.release(band_start_row, band_start_row + band_num_rows);
+        }
 
-#pragma omp parallel for private(nodes) reduction(+:num_exchanges) schedule(static)
-        for (long idx = 0; idx < num_elems; ++idx) {
-            long projected_x = idx % projected_num_cols;
-            long projected_y = idx / projected_num_cols;
+        return num_exchanges;
+    }
 
-            long partition_x = projected_x / partition_len;
-            long partition_y = projected_y / partition_len;
+    /**
+     * Exchange whole partitions as subtrees within every exchange block, based on the values of the partitions.
+     * The exchanges are recorded in the partition table of the quad tree, which redirects the nodes of the exchanged partitions
+     * instead of rewriting their leaves. The table is kept while the partitions of the same height are exchanged.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param quad_tree
+     * @param distance_function
+     * @param target_table
+     * @param partition_height  The height of the partitions being exchanged.
+     * @param group_len Number of partitions per dimension of an exchange block.
+     * @param shift_len Number of partitions the exchange blocks are shifted back by.
+     * @return
+     */
+    template<typename VectorType, typename DistanceFunction>
+    size_t performSubtreeExchanges(
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        DistanceFunction distance_function,
+        TargetTable<VectorType> &target_table,
+        const size_t partition_height,
+        const long group_len,
+        const long shift_len
+    ) {
+        using namespace ldg;
+
+        auto [partitions_num_rows, partitions_num_cols] = quad_tree.getBounds(partition_height).second;
+        long num_partition_rows = static_cast<long>(partitions_num_rows);
+        long num_partition_cols = static_cast<long>(partitions_num_cols);
+        long num_block_rows = (num_partition_rows + shift_len + group_len - 1) / group_len;
+        long num_block_cols = (num_partition_cols + shift_len + group_len - 1) / group_len;
 
-            long within_partition_x = projected_x % partition_len;
-            long within_partition_y = projected_y % partition_len;
-            long within_partition_index = ldg::rowMajorIndex(within_partition_y, within_partition_x, partition_len);
+        quad_tree.preparePartitionTable(partition_height);
+        std::vector<CellPosition> nodes;
+        nodes.reserve(group_len * group_len);
+        size_t num_exchanges = 0;
 
-            long base_x = offset_x + partition_x * partition_len * 2;
-            long base_y = offset_y + partition_y * partition_len * 2;
+#pragma omp parallel for private(nodes) reduction(+:num_exchanges) schedule(static)
+        for (long idx = 0; idx < num_block_rows * num_block_cols; ++idx) {
+            long base_y = (idx / num_block_cols) * group_len - shift_len;
+            long base_x = (idx % num_block_cols) * group_len - shift_len;
 
-            // Pair nodes and perform exchanges
             nodes.clear();
-            long count = 0;   // Use a count to adjust for selecting the neighbouring partitions
-            for (auto &cell_pairings : cell_pairings_array) {
-                long pair_index = cell_pairings[within_partition_index];
-                long pair_x = base_x + pair_index % partition_len + (count % 2) * partition_len;
-                long pair_y = base_y + pair_index / partition_len + (count / 2) * partition_len;
-
-                // Check if this node is within range
-                if (pair_x >= 0 && pair_x < comparison_num_cols && pair_y >= 0 && pair_y < comparison_num_rows) {
-                    nodes.push_back(ldg::CellPosition{ 0, ldg::rowMajorIndex(pair_y, pair_x, comparison_num_cols) });
-                }
-                ++count;
+            for (long y = std::max(base_y, 0l); y < std::min(base_y + group_len, num_partition_rows); ++y) {
+                for (long x = std::max(base_x, 0l); x < std::min(base_x + group_len, num_partition_cols); ++x)
+                    nodes.push_back(CellPosition{ partition_height, rowMajorIndex(y, x, num_partition_cols) });
             }
-            num_exchanges += nodes.size() > 1 ? findAndSwapBestPermutation(nodes, quad_tree, distance_function, target_map) : 0;
+            num_exchanges += nodes.size() > 1 ? findAndSwapBestSubtreePermutation(nodes, quad_tree, distance_function, target_table) : 0;
         }
 
         return num_exchanges;
@@ -119,52 +240,87 @@ namespace ssm
      * Start partition optimization by performing exchanges. This function in particular applies the even-odd or odd-even swapping.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
      * @param quad_tree
      * @param distance_function
+     * @param target_cache  Targets of both configurations that are reused between calls.
      * @param partition_height  The height of the partitions being compared.
      * @param ssm_mode
+     * @param group_len Number of partitions per dimension of an exchange block.
+     * @param subtree_exchanges Whether whole partitions should be exchanged before exchanging their cells.
+     * @param neighbourhood_len Number of partitions per dimension of the partition neighbourhood target.
+     * @param active_set    Changed partitions to limit the exchanges to, or nullptr to compare all blocks.
+     * @param target_distances  Storage for the distances of the leaves to their targets, which is reused between calls.
      * @param apply_shift   Whether the shift (odd-even) configuration should be used.
      * @return
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     size_t optimizePartitions(
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
+        TargetCache<VectorType> &target_cache,
         const size_t partition_height,
         const bool ssm_mode,
+        const size_t group_len,
+        const bool subtree_exchanges,
+        const size_t neighbourhood_len,
+        ActiveSet *active_set,
+        TargetDistances &target_distances,
         const bool apply_shift
     ) {
         using namespace ldg;
 
-        long partition_len = long(std::pow(2., partition_height));
+        long partition_len = long(1) << partition_height;
         std::pair<long, long> offset{ 0, 0 };
         std::pair<long, long> iteration_dims(quad_tree.getBounds(0).second);
 
-        if (apply_shift) {  // Odd-even configuration - We basically shift the whole block back by the size of the partition
-            offset.first -= partition_len;
-            offset.second -= partition_len;
-            iteration_dims.first += 2 * partition_len;
-            iteration_dims.second += 2 * partition_len;
+        long block_len = static_cast<long>(group_len) * partition_len;
+
+        if (apply_shift) {  // Odd-even configuration - We basically shift the whole block back by half of the block, rounded down to partitions
+            long shift_len = static_cast<long>(group_len / 2) * partition_len;
+            offset.first -= shift_len;
+            offset.second -= shift_len;
+            iteration_dims.first += block_len;
+            iteration_dims.second += block_len;
         }
 
-        computeParents(quad_tree, distance_function);
-        auto target_map = getTargetMap(
-            ssm_mode ? TargetType::PARTITION_NEIGHBOURHOOD : TargetType::HIGHEST_PARENT_HIERARCHY,
-            quad_tree,
-            distance_function,
-            partition_height,
-            apply_shift
-        );
-        auto cell_pairing_array= generateCellPairings(partition_len * partition_len, !ssm_mode);
+        auto &target_table = target_cache.getTargetTable(apply_shift);
+        auto load_targets = [&]() {
+            computeParents(quad_tree, distance_function);
+            target_cache.load(
+                ssm_mode ? TargetType::PARTITION_NEIGHBOURHOOD : TargetType::HIGHEST_PARENT_HIERARCHY,
+                quad_tree,
+                distance_function,
+                partition_height,
+                apply_shift,
+                neighbourhood_len
+            );
+        };
+        load_targets();
+
+        size_t num_exchanges = 0;
+        if (subtree_exchanges) {
+            long shift_len = apply_shift ? static_cast<long>(group_len / 2) : 0;
+            num_exchanges += performSubtreeExchanges(quad_tree, distance_function, target_table, partition_height, static_cast<long>(group_len), shift_len);
+            if (num_exchanges > 0) {    // The parents above the moved subtrees and the targets changed
+                load_targets();
+                if (active_set != nullptr)
+                    active_set->markAllChanged();
+            }
+        }
+        auto cell_pairing_array = generateCellPairings(partition_len * partition_len, group_len * group_len, !ssm_mode);
 
-        return performPartitionExchanges(
+        return num_exchanges + performPartitionExchanges(
             quad_tree,
             distance_function,
-            target_map,
+            target_table,
             cell_pairing_array,
             partition_len,
+            static_cast<long>(group_len),
             offset,
-            iteration_dims
+            iteration_dims,
+            active_set,
+            target_distances
         );
     }
 }
@@ -0,0 +1,182 @@
+#ifndef LDG_CORE_PERMUTATIONS_HPP
+#define LDG_CORE_PERMUTATIONS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace ssm
+{
+    constexpr size_t MAX_EXCHANGE_GROUP_LEN = 4;    // Maximum number of partitions per dimension of an exchange block.
+    constexpr size_t MAX_EXCHANGE_NODES = MAX_EXCHANGE_GROUP_LEN * MAX_EXCHANGE_GROUP_LEN;
+
+    /**
+     * Cost of placing the contents of a node (row) at the position of a node (column) within an exchange group.
+     */
+    using CostMatrix = std::array<std::array<double, MAX_EXCHANGE_NODES>, MAX_EXCHANGE_NODES>;
+
+    using Permutation = std::array<uint8_t, MAX_EXCHANGE_NODES>;
+
+    /**
+     * @param num
+     * @return
+     */
+    constexpr size_t factorial(size_t num)
+    {
+        return num <= 1 ? 1 : num * factorial(num - 1);
+    }
+
+    /**
+     * Generate all permutations of NumNodes nodes in lexicographic order, such that they can be stored as a table at compile time.
+     * Unused trailing entries of each permutation map to themselves.
+     *
+     * @tparam NumNodes
+     * @return
+     */
+    template<size_t NumNodes>
+    constexpr std::array<Permutation, factorial(NumNodes)> generatePermutations()
+    {
+        std::array<Permutation, factorial(NumNodes)> permutations{};
+        Permutation permutation{};
+        std::iota(permutation.begin(), permutation.end(), 0);
+        size_t idx = 0;
+        do {
+            permutations[idx++] = permutation;
+        } while (std::next_permutation(permutation.begin(), permutation.begin() + NumNodes));
+        return permutations;
+    }
+
+    template<size_t NumNodes>
+    constexpr auto PERMUTATIONS = generatePermutations<NumNodes>();
+
+    /**
+     * Find the permutation with the lowest total cost, where node permutation[idx] is placed at position idx.
+     * Ties are resolved in favour of the lexicographically first permutation, which is the identity if nothing improves on it.
+     *
+     * @tparam NumNodes
+     * @param costs
+     * @return
+     */
+    template<size_t NumNodes>
+    Permutation findBestPermutation(CostMatrix const &costs)
+    {
+        size_t best_idx = 0;
+        double minimum_distance = -1.;
+        for (size_t permutation_idx = 0; permutation_idx < PERMUTATIONS<NumNodes>.size(); ++permutation_idx) {
+            auto const &permutation = PERMUTATIONS<NumNodes>[permutation_idx];
+            double distance = 0.;
+            for (size_t idx = 0; idx < NumNodes; ++idx)
+                distance += costs[permutation[idx]][idx];
+
+            if (minimum_distance == -1 || minimum_distance > distance) {
+                minimum_distance = distance;
+                best_idx = permutation_idx;
+            }
+        }
+        return PERMUTATIONS<NumNodes>[best_idx];
+    }
+
+    /**
+     * Solve the linear assignment problem of a cost matrix using the Hungarian method with potentials, which takes O(n^3) time.
+     * All costs must be finite.
+     *
+     * @param costs
+     * @param num_nodes
+     * @return The permutation with the lowest total cost, where node permutation[idx] is placed at position idx.
+     */
+    inline Permutation solveAssignment(CostMatrix const &costs, size_t num_nodes)
+    {
+        // Positions are the rows and nodes the columns of the problem, which is indexed from 1 such that 0 can act as a sentinel.
+        constexpr double infinity = std::numeric_limits<double>::infinity();
+        std::array<double, MAX_EXCHANGE_NODES + 1> position_potentials{}, node_potentials{}, minimum_slack{};
+        std::array<size_t, MAX_EXCHANGE_NODES + 1> node_positions{}, previous_nodes{};
+        std::array<bool, MAX_EXCHANGE_NODES + 1> is_used{};
+
+        for (size_t position = 1; position <= num_nodes; ++position) {
+            node_positions[0] = position;
+            size_t node = 0;
+            minimum_slack.fill(infinity);
+            is_used.fill(false);
+
+            // Grow an alternating tree from the new position until a free node is reached
+            do {
+                is_used[node] = true;
+                size_t current_position = node_positions[node];
+                size_t next_node = 0;
+                double delta = infinity;
+                for (size_t candidate = 1; candidate <= num_nodes; ++candidate) {
+                    if (is_used[candidate])
+                        continue;
+                    double slack = costs[candidate - 1][current_position - 1] - position_potentials[current_position] - node_potentials[candidate];
+                    if (slack < minimum_slack[candidate]) {
+                        minimum_slack[candidate] = slack;
+                        previous_nodes[candidate] = node;
+                    }
+                    if (minimum_slack[candidate] < delta) {
+                        delta = minimum_slack[candidate];
+                        next_node = candidate;
+                    }
+                }
+                for (size_t candidate = 0; candidate <= num_nodes; ++candidate) {
+                    if (is_used[candidate]) {
+                        position_potentials[node_positions[candidate]] += delta;
+                        node_potentials[candidate] -= delta;
+                    } else {
+                        minimum_slack[candidate] -= delta;
+                    }
+                }
+                node = next_node;
+            } while (node_positions[node] != 0);
+
+            // Augment along the path
+            do {
+                size_t previous_node = previous_nodes[node];
+                node_positions[node] = node_positions[previous_node];
+                node = previous_node;
+            } while (node != 0);
+        }
+
+        Permutation permutation{};
+        std::iota(permutation.begin(), permutation.end(), 0);
+        for (size_t node = 1; node <= num_nodes; ++node)
+            permutation[node_positions[node] - 1] = static_cast<uint8_t>(node - 1);
+        return permutation;
+    }
+
+    /**
+     * Find the permutation with the lowest total cost for a runtime number of nodes.
+     * Small groups enumerate all permutations, while larger groups are solved as a linear assignment problem. The solver is only
+     * used if it strictly improves on keeping all nodes in place, such that ties never cause exchanges.
+     *
+     * @param costs
+     * @param num_nodes At most MAX_EXCHANGE_NODES.
+     * @return
+     */
+    inline Permutation findBestPermutation(CostMatrix const &costs, size_t num_nodes)
+    {
+        switch (num_nodes) {
+            case 4:
+                return findBestPermutation<4>(costs);
+            case 3:
+                return findBestPermutation<3>(costs);
+            case 2:
+                return findBestPermutation<2>(costs);
+            case 1:
+            case 0:
+                return PERMUTATIONS<1>[0];
+        }
+
+        auto permutation = solveAssignment(costs, num_nodes);
+        double identity_distance = 0.;
+        double distance = 0.;
+        for (size_t idx = 0; idx < num_nodes; ++idx) {
+            identity_distance += costs[idx][idx];
+            distance += costs[permutation[idx]][idx];
+        }
+        return distance < identity_distance ? permutation : PERMUTATIONS<1>[0];
+    }
+}
+
+#endif //LDG_CORE_PERMUTATIONS_HPP
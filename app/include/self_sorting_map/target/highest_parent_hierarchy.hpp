@@ -1,60 +1,49 @@
 #ifndef LDG_CORE_HIGHEST_PARENT_HIERARCHY_HPP
 #define LDG_CORE_HIGHEST_PARENT_HIERARCHY_HPP
 
-#include <vector>
-#include <memory>
 #include "app/include/ldg/model/cell_position.hpp"
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 #include "app/include/ldg/util/tree_traversal/tree_walker.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
 
 namespace ssm
 {
     /**
-     * Load the parent targets into a targets data array.
+     * Load the parent targets into a target table.
      * This target is the last unique parent when considering comparisons, representing a hierarchical neighbourhood.
      *
      * @tparam VectorType
-     * @param target_map
+     * @param target_table
      * @param quad_tree
      * @param partition_height
      * @param is_shift
+     * @param partitions    Row-major flags of the partitions to load the targets of, or empty for all partitions.
      */
     template<typename VectorType>
     void loadHighestParentHierarchyTargets(
-        std::vector<std::vector<std::shared_ptr<VectorType>>> &target_map,
+        TargetTable<VectorType> &target_table,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
         const size_t partition_height,
-        bool is_shift
+        bool is_shift,
+        std::vector<uint8_t> const &partitions
     )
     {
         using namespace ldg;
         auto projected_dims = quad_tree.getBounds(partition_height).second;
-        auto [num_rows, num_cols] = quad_tree.getBounds(0).second;
         size_t num_elems = projected_dims.first * projected_dims.second;
-        size_t partition_len = size_t(std::pow(2, partition_height));
 
 #pragma omp parallel for schedule(static)
         for (size_t idx = 0; idx < num_elems; ++idx) {
-            int partition_x = idx % projected_dims.second;
-            int partition_y = idx / projected_dims.second;
+            if (!partitions.empty() && !partitions[idx])
+                continue;
+
             size_t max_parent_height = is_shift ? partition_height + 1: partition_height;
 
             TreeWalker<VectorType> walker{ CellPosition{ partition_height, idx }, quad_tree };
             for (size_t height = partition_height; height < max_parent_height; ++height) {
                 walker.moveUp();
             }
-            auto target = walker.getNodeValue();
-
-            // Copy to all relevant cells
-            size_t min_y = partition_y * partition_len;
-            size_t max_y = std::min(min_y + partition_len, num_rows);
-            size_t min_x = partition_x * partition_len;
-            size_t max_x = std::min(min_x + partition_len, num_cols);
-            for (size_t y = min_y; y < max_y; ++y) {
-                for (size_t x = min_x; x < max_x; ++x) {
-                    target_map[rowMajorIndex(y, x, num_cols)].push_back(target);
-                }
-            }
+            target_table.addTarget(idx, walker.getNodeValue());
         }
     }
 }
@@ -1,48 +1,75 @@
 #ifndef LDG_CORE_PARTITION_NEIGHBOURHOOD_TARGET_HPP
 #define LDG_CORE_PARTITION_NEIGHBOURHOOD_TARGET_HPP
 
+#include <algorithm>
 #include "app/include/ldg/model/cell_position.hpp"
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/ldg/util/summed_area_table.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
 
 namespace ssm
 {
-    size_t PARTITION_NUM_BLOCKS_PER_DIMENSION = 4;
+    constexpr size_t PARTITION_NUM_BLOCKS_PER_DIMENSION = 4;   // Default number of partitions per dimension of the neighbourhood.
 
     /**
-     * Load the neighbourhood targets into a target array.
+     * @param neighbourhood_len Number of partitions per dimension of the neighbourhood.
+     * @return The number of partitions in each direction that the targets of a partition are aggregated from at its height.
+     */
+    inline long getPartitionNeighbourhoodRadius(size_t neighbourhood_len)
+    {
+        return std::max(long(1), static_cast<long>(neighbourhood_len + 1) / 2);
+    }
+
+    /**
+     * Load the neighbourhood targets into a target table.
      * The partition neighbourhood target basically aggregates the aggregates in the neighbourhood of th partition at the partition height.
-     * This is very much just equivalent to convolution with an equally weighted NUM_BLOCKS_PER_DIMENSIONxNUM_BLOCKS_PER_DIMENSION kernel, just ignoring nullptrs.
+     * This is very much just equivalent to convolution with an equally weighted neighbourhood_len x neighbourhood_len kernel, just ignoring nullptrs.
+     * For averaged parents, windows that are large enough are looked up in a summed-area table, such that their cost does not depend
+     * on the window size. Smaller windows are summed directly, as building the table would cost more than it saves.
      *
      * @tparam VectorType
-     * @param target_map
+     * @tparam DistanceFunction
+     * @param target_table
      * @param quad_tree
      * @param distance_function
      * @param partition_height
      * @param is_shift
+     * @param neighbourhood_len Number of partitions per dimension of the neighbourhood.
+     * @param summed_area_table Table that is kept between loads, which is updated if the windows are looked up in it.
+     * @param partitions    Row-major flags of the partitions to load the targets of, or empty for all partitions.
      */
-    template<typename VectorType>
+    template<typename VectorType, typename DistanceFunction>
     void loadPartitionNeighbourhoodTargets(
-        std::vector<std::vector<std::shared_ptr<VectorType>>> &target_map,
+        TargetTable<VectorType> &target_table,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
         const size_t partition_height,
-        bool is_shift
+        bool is_shift,
+        const size_t neighbourhood_len,
+        ldg::SummedAreaTable<VectorType> &summed_area_table,
+        std::vector<uint8_t> const &partitions
     )
     {
         using namespace ldg;
         auto projected_dims = quad_tree.getBounds(partition_height).second;
         size_t num_elems = projected_dims.first * projected_dims.second;
 
-        auto [num_rows, num_cols] = quad_tree.getBounds(0).second;
-        size_t partition_len = size_t(std::pow(2, partition_height));
-        std::vector<std::shared_ptr<VectorType>> values;
-        values.reserve(PARTITION_NUM_BLOCKS_PER_DIMENSION * PARTITION_NUM_BLOCKS_PER_DIMENSION);
+        std::vector<ldg::VectorView<VectorType>> values;
+        std::vector<double> distances;
+        std::vector<const typename VectorType::Scalar *> rows;
 
-        int shift = is_shift ? 0 : (PARTITION_NUM_BLOCKS_PER_DIMENSION - 1) % 2;
-        int blocks_offset = (PARTITION_NUM_BLOCKS_PER_DIMENSION - 1) / 2;
+        int shift = is_shift ? 0 : static_cast<int>(neighbourhood_len - 1) % 2;
+        int blocks_offset = static_cast<int>(neighbourhood_len - 1) / 2;
+        bool is_average = quad_tree.getParentType() == ParentType::NORMALIZED_AVERAGE;
+        bool use_summed_area_table = is_average && SummedAreaTable<VectorType>::isFasterThanSumming(static_cast<size_t>(2 * blocks_offset + shift));
+        if (use_summed_area_table)
+            summed_area_table.update(quad_tree, partition_height);
 
-#pragma omp parallel for private(values) schedule(static)
+#pragma omp parallel for private(values, distances, rows) schedule(static)
         for (size_t idx = 0; idx < num_elems; ++idx) {
+            if (!partitions.empty() && !partitions[idx])
+                continue;
+
             int partition_x = idx % projected_dims.second;
             int partition_y = idx / projected_dims.second;
 
@@ -51,26 +78,21 @@ namespace ssm
             size_t min_x = std::max(partition_x - blocks_offset - (partition_x % 2 == 0 ? 1 : 0) * shift, 0);
             size_t max_x = std::min(static_cast<size_t>(partition_x + blocks_offset + (partition_x % 2) * shift), projected_dims.second);
 
-            for (size_t y = min_y; y < max_y; ++y) {
-                for (size_t x = min_x; x < max_x; ++x) {
-                    values.push_back(quad_tree.getValue(CellPosition{ partition_height, rowMajorIndex(y, x, projected_dims.second) }));
-                }
+            if (use_summed_area_table) {
+                VectorType target = summed_area_table.getAverage(min_y, max_y, min_x, max_x);
+                target_table.addTarget(idx, VectorView<VectorType>(&target));
+                continue;
             }
-            auto target = std::make_shared<VectorType>(quad_tree.getParentType() == ParentType::NORMALIZED_AVERAGE ?
-                aggregate(values, quad_tree.getDataElementLen()) :
-                findMinimum(values, distance_function)
-            );
 
-            // Copy to all relevant cells
-            min_y = partition_y * partition_len;
-            max_y = std::min(min_y + partition_len, num_rows);
-            min_x = partition_x * partition_len;
-            max_x = std::min(min_x + partition_len, num_cols);
             for (size_t y = min_y; y < max_y; ++y) {
                 for (size_t x = min_x; x < max_x; ++x) {
-                    target_map[rowMajorIndex(y, x, num_cols)].push_back(target);
+                    values.push_back(quad_tree.getValue(CellPosition{ partition_height, rowMajorIndex(y, x, projected_dims.second) }));
                 }
             }
+            VectorType target = is_average ?
+                aggregate(values, quad_tree.getDataElementLen(), rows) :
+                findMinimum(values, distance_function, distances);
+            target_table.addTarget(idx, VectorView<VectorType>(&target));
 
             values.clear();
         }
@@ -0,0 +1,134 @@
+#ifndef LDG_CORE_TARGET_TABLE_HPP
+#define LDG_CORE_TARGET_TABLE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "app/include/ldg/model/cell_position.hpp"
+#include "app/include/ldg/model/feature_matrix.hpp"
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+
+namespace ssm
+{
+    constexpr size_t MAX_TARGETS_PER_PARTITION = 2;     // The highest parent and the partition neighbourhood.
+
+    /**
+     * The targets of all partitions at a height. Since all leaves of a partition share the same targets, they are stored once per
+     * partition as rows of a flat feature matrix, which also caches their norms. Leaves look up the targets of their partition.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    class TargetTable
+    {
+        size_t partition_height = 0;
+        size_t num_cols = 0;    // Number of columns of leaves.
+        size_t num_partition_cols = 0;
+        ldg::FeatureMatrix<VectorType> targets;
+        std::vector<uint8_t> num_targets;   // Number of targets per partition.
+
+    public:
+        void reset(ldg::QuadAssignmentTree<VectorType> &quad_tree, size_t partition_height);
+
+        size_t getPartition(size_t leaf_index) const;
+
+        size_t getNumTargets(size_t partition) const;
+
+        ldg::VectorView<VectorType> getTarget(size_t partition, size_t target_idx) const;
+
+        void addTarget(size_t partition, ldg::VectorView<VectorType> value);
+
+        void clearTargets(size_t partition);
+    };
+
+    /**
+     * Remove all targets and prepare the table for the partitions at a height.
+     * The storage is only reallocated if the number of partitions changes, such that the table can be reused every iteration.
+     *
+     * @tparam VectorType
+     * @param quad_tree
+     * @param partition_height
+     */
+    template<typename VectorType>
+    void TargetTable<VectorType>::reset(ldg::QuadAssignmentTree<VectorType> &quad_tree, size_t partition_height)
+    {
+        auto [num_partition_rows, num_partition_cols] = quad_tree.getBounds(partition_height).second;
+        size_t num_partitions = num_partition_rows * num_partition_cols;
+        this->partition_height = partition_height;
+        this->num_cols = quad_tree.getBounds(0).second.second;
+        this->num_partition_cols = num_partition_cols;
+
+        if (targets.size() != num_partitions * MAX_TARGETS_PER_PARTITION || targets.getElementLen() != quad_tree.getDataElementLen())
+            targets = ldg::FeatureMatrix<VectorType>(num_partitions * MAX_TARGETS_PER_PARTITION, quad_tree.getDataElementLen());
+        num_targets.assign(num_partitions, 0);
+    }
+
+    /**
+     * @tparam VectorType
+     * @param leaf_index    Row-major index of a leaf.
+     * @return The index of the partition containing the leaf.
+     */
+    template<typename VectorType>
+    size_t TargetTable<VectorType>::getPartition(size_t leaf_index) const
+    {
+        size_t row = leaf_index / num_cols;
+        size_t col = leaf_index % num_cols;
+        return ldg::rowMajorIndex(row >> partition_height, col >> partition_height, num_partition_cols);
+    }
+
+    /**
+     * @tparam VectorType
+     * @param partition
+     * @return
+     */
+    template<typename VectorType>
+    size_t TargetTable<VectorType>::getNumTargets(size_t partition) const
+    {
+        return num_targets[partition];
+    }
+
+    /**
+     * @tparam VectorType
+     * @param partition
+     * @param target_idx
+     * @return A view of the target, which is empty for void targets.
+     */
+    template<typename VectorType>
+    ldg::VectorView<VectorType> TargetTable<VectorType>::getTarget(size_t partition, size_t target_idx) const
+    {
+        return targets.getRow(partition * MAX_TARGETS_PER_PARTITION + target_idx);
+    }
+
+    /**
+     * Add a target to a partition. Empty values are added as void targets, which have no distance.
+     * This is safe to call concurrently for different partitions.
+     *
+     * @tparam VectorType
+     * @param partition
+     * @param value
+     */
+    template<typename VectorType>
+    void TargetTable<VectorType>::addTarget(size_t partition, ldg::VectorView<VectorType> value)
+    {
+        size_t row = partition * MAX_TARGETS_PER_PARTITION + num_targets[partition]++;
+        if (value == nullptr || value.size() == 0) {
+            targets.clearRow(row);
+        } else {
+            targets.setRow(row, *value);
+        }
+    }
+
+    /**
+     * Remove the targets of a partition, such that they can be loaded again without resetting the whole table.
+     *
+     * @tparam VectorType
+     * @param partition
+     */
+    template<typename VectorType>
+    void TargetTable<VectorType>::clearTargets(size_t partition)
+    {
+        num_targets[partition] = 0;
+    }
+}
+
+#endif //LDG_CORE_TARGET_TABLE_HPP
@@ -0,0 +1,144 @@
+#ifndef LDG_CORE_TARGET_CACHE_HPP
+#define LDG_CORE_TARGET_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "app/include/ldg/model/cell_position.hpp"
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/ldg/util/summed_area_table.hpp"
+#include "app/include/self_sorting_map/target/partition_neighbourhood_target.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
+#include "app/include/self_sorting_map/target/target_type.hpp"
+#include "app/include/self_sorting_map/targets.hpp"
+
+namespace ssm
+{
+    /**
+     * The target tables of both configurations (regular and shifted), each of which is kept for the height and parent version it was
+     * loaded for. When the targets of the same height and configuration are loaded again, only the partitions of which a parent
+     * they are aggregated from was recomputed since then are reloaded.
+     *
+     * @tparam VectorType
+     */
+    template<typename VectorType>
+    class TargetCache
+    {
+        struct Entry
+        {
+            TargetTable<VectorType> target_table;
+            size_t partition_height = 0;
+            uint32_t parent_version = 0;    // Parent version the targets were loaded for.
+            bool is_loaded = false;
+        };
+
+        std::array<Entry, 2> entries;   // Per configuration.
+        ldg::SummedAreaTable<VectorType> summed_area_table;    // Shared by both configurations, and only resummed where parents changed.
+
+        std::vector<uint8_t> findStalePartitions(ldg::QuadAssignmentTree<VectorType> &quad_tree, Entry const &entry, size_t neighbourhood_len) const;
+
+    public:
+        TargetTable<VectorType> &getTargetTable(bool is_shift);
+
+        template<typename DistanceFunction>
+        void load(
+            TargetType target_type,
+            ldg::QuadAssignmentTree<VectorType> &quad_tree,
+            DistanceFunction distance_function,
+            size_t partition_height,
+            bool is_shift,
+            size_t neighbourhood_len
+        );
+    };
+
+    /**
+     * @tparam VectorType
+     * @param is_shift
+     * @return The target table of a configuration, as last loaded.
+     */
+    template<typename VectorType>
+    TargetTable<VectorType> &TargetCache<VectorType>::getTargetTable(bool is_shift)
+    {
+        return entries[is_shift ? 1 : 0].target_table;
+    }
+
+    /**
+     * Load the targets of a configuration, reusing the targets of partitions that are unchanged since they were last loaded.
+     * The parents should be computed beforehand.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param target_type
+     * @param quad_tree
+     * @param distance_function
+     * @param partition_height
+     * @param is_shift
+     * @param neighbourhood_len Number of partitions per dimension of the partition neighbourhood.
+     */
+    template<typename VectorType>
+    template<typename DistanceFunction>
+    void TargetCache<VectorType>::load(
+        TargetType target_type,
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        DistanceFunction distance_function,
+        size_t partition_height,
+        bool is_shift,
+        size_t neighbourhood_len
+    )
+    {
+        auto &entry = entries[is_shift ? 1 : 0];
+        if (!entry.is_loaded || entry.partition_height != partition_height) {
+            loadTargetTable(entry.target_table, target_type, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len, summed_area_table, {});
+        } else if (entry.parent_version != quad_tree.getParentVersion()) {
+            auto stale_partitions = findStalePartitions(quad_tree, entry, neighbourhood_len);
+            if (std::find(stale_partitions.begin(), stale_partitions.end(), 1) != stale_partitions.end())
+                loadTargetTable(entry.target_table, target_type, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len, summed_area_table, stale_partitions);
+        }
+
+        entry.partition_height = partition_height;
+        entry.parent_version = quad_tree.getParentVersion();
+        entry.is_loaded = true;
+    }
+
+    /**
+     * Find the partitions of which a node within the partition neighbourhood was recomputed since the targets were loaded.
+     * This also covers the highest parent hierarchy target, as the parent of a partition only changes if one of its children does.
+     *
+     * @tparam VectorType
+     * @param quad_tree
+     * @param entry
+     * @param neighbourhood_len Number of partitions per dimension of the partition neighbourhood.
+     * @return Row-major flags of the partitions that should be reloaded.
+     */
+    template<typename VectorType>
+    std::vector<uint8_t> TargetCache<VectorType>::findStalePartitions(ldg::QuadAssignmentTree<VectorType> &quad_tree, Entry const &entry, size_t neighbourhood_len) const
+    {
+        using namespace ldg;
+        auto [num_rows, num_cols] = quad_tree.getBounds(entry.partition_height).second;
+        long radius = getPartitionNeighbourhoodRadius(neighbourhood_len);
+
+        std::vector<uint8_t> is_changed(num_rows * num_cols, 0);
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < num_rows * num_cols; ++idx)
+            is_changed[idx] = quad_tree.getNodeVersion(CellPosition{ entry.partition_height, idx }) > entry.parent_version;
+
+        std::vector<uint8_t> is_stale(num_rows * num_cols, 0);
+#pragma omp parallel for schedule(static)
+        for (size_t idx = 0; idx < num_rows * num_cols; ++idx) {
+            long row = static_cast<long>(idx / num_cols);
+            long col = static_cast<long>(idx % num_cols);
+            long min_y = std::max(row - radius, long(0));
+            long max_y = std::min(row + radius + 1, static_cast<long>(num_rows));
+            long min_x = std::max(col - radius, long(0));
+            long max_x = std::min(col + radius + 1, static_cast<long>(num_cols));
+            for (long y = min_y; y < max_y && !is_stale[idx]; ++y) {
+                for (long x = min_x; x < max_x && !is_stale[idx]; ++x)
+                    is_stale[idx] = is_changed[rowMajorIndex(y, x, num_cols)];
+            }
+        }
+        return is_stale;
+    }
+}
+
+#endif //LDG_CORE_TARGET_CACHE_HPP
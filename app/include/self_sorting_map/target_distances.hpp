@@ -0,0 +1,249 @@
+#ifndef LDG_CORE_TARGET_DISTANCES_HPP
+#define LDG_CORE_TARGET_DISTANCES_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <Eigen/Core>
+#include "app/include/ldg/model/cell_position.hpp"
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/ldg/util/metric/distance_function_types.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
+
+namespace ssm
+{
+    constexpr long TARGET_DISTANCES_TILE_LEN = 64;    // Number of leaves gathered per matrix product.
+    constexpr double TARGET_DISTANCES_CANCELLATION_RATIO = 1e-6;   // Squared distance relative to the squared norms below which the distance is computed directly.
+    constexpr long TARGET_DISTANCES_MAX_ENTRIES = 1 << 22;  // Number of distances that are held at once, which bounds their memory to 32 MB.
+
+    /**
+     * Check if the element-by-target distances can be computed as matrix products for a data and distance function type.
+     * Integer data is excluded, since its dot products would overflow in the data type itself.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @return
+     */
+    template<typename VectorType, typename DistanceFunction>
+    constexpr bool supportsTargetDistances()
+    {
+        return std::is_floating_point_v<typename VectorType::Scalar> && ldg::DotProductDistance<DistanceFunction>;
+    }
+
+    /**
+     * Get the number of exchanges of which the target distances can be held at once.
+     *
+     * @param group_len Number of partitions per dimension of an exchange block.
+     * @return
+     */
+    inline long getTargetDistancesChunkLen(long group_len)
+    {
+        return std::max(long(1), TARGET_DISTANCES_MAX_ENTRIES / (group_len * group_len * group_len * group_len));
+    }
+
+    /**
+     * The summed distances of the elements of a range of exchanges to the targets of each of the partitions of their exchange block.
+     * An exchange pairs up one cell of every partition of an exchange block, which is identified by the position (slot) of its
+     * partition in the block. The distances are held for a chunk of exchanges at a time, such that their memory does not depend
+     * on the size of the grid. The matrix is kept between resets, such that it is only allocated when it grows.
+     */
+    class TargetDistances
+    {
+        Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> distances;  // Per exchange and element slot, the distance to the targets of every slot.
+        long num_slots = 1;
+        long start_exchange = 0;
+
+    public:
+        void reset(long start_exchange, long end_exchange, long group_len);
+
+        double &at(long exchange, int element_slot, int target_slot);
+
+        double operator()(long exchange, int element_slot, int target_slot) const;
+    };
+
+    /**
+     * Prepare the distances of a range of exchanges, which are all set to 0.
+     *
+     * @param start_exchange
+     * @param end_exchange  Exclusive.
+     * @param group_len Number of partitions per dimension of an exchange block.
+     */
+    inline void TargetDistances::reset(long start_exchange, long end_exchange, long group_len)
+    {
+        num_slots = group_len * group_len;
+        this->start_exchange = start_exchange;
+        auto num_rows = static_cast<Eigen::Index>((end_exchange - start_exchange) * num_slots);
+        if (distances.rows() < num_rows || distances.cols() != num_slots)
+            distances.resize(num_rows, num_slots);
+        distances.topRows(num_rows).setZero();
+    }
+
+    /**
+     * @param exchange
+     * @param element_slot  Slot of the partition of the element.
+     * @param target_slot   Slot of the partition of the targets.
+     * @return
+     */
+    inline double &TargetDistances::at(long exchange, int element_slot, int target_slot)
+    {
+        return distances((exchange - start_exchange) * num_slots + element_slot, target_slot);
+    }
+
+    /**
+     * Get the summed distance of the element of an exchange in one slot to the targets of another slot.
+     *
+     * @param exchange
+     * @param element_slot
+     * @param target_slot
+     * @return
+     */
+    inline double TargetDistances::operator()(long exchange, int element_slot, int target_slot) const
+    {
+        return distances((exchange - start_exchange) * num_slots + element_slot, target_slot);
+    }
+
+    /**
+     * Compute the distances of the elements of a range of exchanges to the targets of their exchange blocks at once.
+     * Exchange idx compares cell cell_pairings_array[slot][idx % block_num_elems] of every slot of block blocks[idx / block_num_elems].
+     * Per block and slot, the elements are gathered in tiles and multiplied with the targets of all slots of their block,
+     * such that the distances follow from a single matrix product per tile instead of many separate vector operations.
+     * The products and norms are computed in double precision, since the distances follow from the difference of the norms and dot
+     * products, which would lose most of its significant digits in single precision for elements close to their targets.
+     * For this reason the cached norms, which are accumulated in the data type, are not used.
+     * Pairs that are (nearly) equal cancel out entirely, so their distance is computed directly. This keeps the distance of an element
+     * to a copy of itself, such as a minimum child target, at exactly 0, as it is for the pairwise distances.
+     * Void elements and targets have no distance.
+     *
+     * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param target_distances  Distances that are reset and filled, which are reused between calls.
+     * @param quad_tree
+     * @param distance_function
+     * @param target_table
+     * @param cell_pairings_array   Per slot, the cell of its partition that every exchange index pairs up.
+     * @param blocks    Row-major indices of the exchange blocks to compare.
+     * @param partition_len
+     * @param group_len Number of partitions per dimension of an exchange block.
+     * @param offset    Offset [rows, columns] of the exchange blocks.
+     * @param num_block_cols    Number of columns of exchange blocks.
+     * @param start_exchange
+     * @param end_exchange  Exclusive.
+     */
+    template<typename VectorType, typename DistanceFunction>
+    void computeTargetDistances(
+        TargetDistances &target_distances,
+        ldg::QuadAssignmentTree<VectorType> &quad_tree,
+        DistanceFunction distance_function,
+        TargetTable<VectorType> const &target_table,
+        std::vector<std::vector<long>> const &cell_pairings_array,
+        std::vector<long> const &blocks,
+        const long partition_len,
+        const long group_len,
+        std::pair<long, long> const &offset,
+        const long num_block_cols,
+        const long start_exchange,
+        const long end_exchange
+    )
+    {
+        using namespace ldg;
+        using RowMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+        auto [num_rows, num_cols] = quad_tree.getBounds(0).second;
+        long block_len = group_len * partition_len;
+        long block_num_elems = partition_len * partition_len;
+        long num_slots = group_len * group_len;
+        auto element_len = static_cast<Eigen::Index>(quad_tree.getDataElementLen());
+        target_distances.reset(start_exchange, end_exchange, group_len);
+
+        // Split the exchanges into tiles that do not cross blocks
+        std::vector<long> tile_starts;
+        for (long idx = start_exchange; idx < end_exchange; idx = std::min({ idx + TARGET_DISTANCES_TILE_LEN, (idx / block_num_elems + 1) * block_num_elems, end_exchange }))
+            tile_starts.push_back(idx);
+        tile_starts.push_back(end_exchange);
+        auto num_tiles = static_cast<long>(tile_starts.size()) - 1;
+
+        RowMatrix targets, elements;
+        Eigen::MatrixXd dot_products;
+        std::vector<double> target_norms, element_norms;
+        std::vector<VectorView<VectorType>> target_values, element_values;
+        std::vector<int> target_slots;
+        std::vector<long> element_exchanges;
+
+#pragma omp parallel for private(targets, elements, dot_products, target_norms, element_norms, target_values, element_values, target_slots, element_exchanges) schedule(dynamic)
+        for (long task = 0; task < num_tiles * num_slots; ++task) {
+            long tile = task / num_slots;
+            int slot = static_cast<int>(task % num_slots);
+            long block = blocks[tile_starts[tile] / block_num_elems];
+            long base_y = offset.first + (block / num_block_cols) * block_len;
+            long base_x = offset.second + (block % num_block_cols) * block_len;
+
+            // Gather the elements of the slot in the tile
+            elements.resize(TARGET_DISTANCES_TILE_LEN, element_len);
+            element_norms.clear();
+            element_values.clear();
+            element_exchanges.clear();
+            for (long exchange = tile_starts[tile]; exchange < tile_starts[tile + 1]; ++exchange) {
+                long pair_index = cell_pairings_array[slot][exchange % block_num_elems];
+                long y = base_y + (slot / group_len) * partition_len + pair_index / partition_len;
+                long x = base_x + (slot % group_len) * partition_len + pair_index % partition_len;
+                if (y < 0 || y >= static_cast<long>(num_rows) || x < 0 || x >= static_cast<long>(num_cols))
+                    continue;
+                auto element = quad_tree.getValue(CellPosition{ 0, rowMajorIndex(y, x, num_cols) });
+                if (element == nullptr)
+                    continue;
+                elements.row(element_exchanges.size()) = (*element).transpose().template cast<double>();
+                element_norms.push_back(elements.row(element_exchanges.size()).norm());
+                element_values.push_back(element);
+                element_exchanges.push_back(exchange);
+            }
+            if (element_exchanges.empty())
+                continue;
+
+            // Gather the targets of all slots of the block
+            targets.resize(2 * num_slots, element_len);
+            target_norms.clear();
+            target_values.clear();
+            target_slots.clear();
+            for (int target_slot = 0; target_slot < num_slots; ++target_slot) {
+                long target_y = base_y + (target_slot / group_len) * partition_len;
+                long target_x = base_x + (target_slot % group_len) * partition_len;
+                if (target_y < 0 || target_y >= static_cast<long>(num_rows) || target_x < 0 || target_x >= static_cast<long>(num_cols))
+                    continue;
+
+                size_t target_partition = target_table.getPartition(rowMajorIndex(target_y, target_x, num_cols));
+                for (size_t target_idx = 0; target_idx < target_table.getNumTargets(target_partition); ++target_idx) {
+                    auto target = target_table.getTarget(target_partition, target_idx);
+                    if (target == nullptr)
+                        continue;
+                    if (static_cast<Eigen::Index>(target_slots.size()) == targets.rows())
+                        targets.conservativeResize(2 * targets.rows(), element_len);
+                    targets.row(target_slots.size()) = (*target).transpose().template cast<double>();
+                    target_norms.push_back(targets.row(target_slots.size()).norm());
+                    target_values.push_back(target);
+                    target_slots.push_back(target_slot);
+                }
+            }
+            if (target_slots.empty())
+                continue;
+
+            auto num_elements = static_cast<Eigen::Index>(element_exchanges.size());
+            auto num_targets = static_cast<Eigen::Index>(target_slots.size());
+            dot_products.noalias() = elements.topRows(num_elements) * targets.topRows(num_targets).transpose();
+            for (Eigen::Index element_idx = 0; element_idx < num_elements; ++element_idx) {
+                for (Eigen::Index target_idx = 0; target_idx < num_targets; ++target_idx) {
+                    double dot_product = dot_products(element_idx, target_idx);
+                    double squared_norms = element_norms[element_idx] * element_norms[element_idx] + target_norms[target_idx] * target_norms[target_idx];
+                    target_distances.at(element_exchanges[element_idx], slot, target_slots[target_idx]) +=
+                        squared_norms - 2. * dot_product <= TARGET_DISTANCES_CANCELLATION_RATIO * squared_norms ?
+                        distance_function(element_values[element_idx], target_values[target_idx]) :
+                        DistanceFunction::fromDotProduct(dot_product, element_norms[element_idx], target_norms[target_idx], element_len);
+                }
+            }
+        }
+    }
+}
+
+#endif //LDG_CORE_TARGET_DISTANCES_HPP
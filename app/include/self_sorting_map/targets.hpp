@@ -1,13 +1,12 @@
 #ifndef LDG_CORE_TARGETS_HPP
 #define LDG_CORE_TARGETS_HPP
 
-#include <vector>
-#include <memory>
 #include "app/include/ldg/model/cell_position.hpp"
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 #include "app/include/self_sorting_map/target/target_type.hpp"
 #include "app/include/self_sorting_map/target/partition_neighbourhood_target.hpp"
 #include "app/include/self_sorting_map/target/highest_parent_hierarchy.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
 
 namespace ssm
 {
@@ -15,38 +14,53 @@ namespace ssm
     /**
      * Calculate the targets per node for a given target type.
      * We calculate everything at once to be able to efficiently reuse targets.
+     * The targets are stored once per partition. The storage of a previous call is reused, such that passing the same table every
+     * iteration avoids reallocating it. If only some partitions are given, the targets of the other partitions are kept.
      *
      * @tparam VectorType
+     * @tparam DistanceFunction
+     * @param target_table  Table that is filled with the targets of each partition at the partition height.
      * @param target_type
      * @param quad_tree
      * @param distance_function
      * @param partition_height
      * @param is_shift
-     * @return  A num_rows x num_cols map at the comparison height where each index contains the targets for that node.
+     * @param neighbourhood_len Number of partitions per dimension of the partition neighbourhood.
+     * @param summed_area_table Table of the partition neighbourhood, which is kept between loads.
+     * @param partitions    Row-major flags of the partitions to load the targets of, or empty for all partitions.
      */
-    template<typename VectorType>
-    std::vector<std::vector<std::shared_ptr<VectorType>>> getTargetMap(
+    template<typename VectorType, typename DistanceFunction>
+    void loadTargetTable(
+        TargetTable<VectorType> &target_table,
         const TargetType target_type,
         ldg::QuadAssignmentTree<VectorType> &quad_tree,
-        std::function<double(std::shared_ptr<VectorType>, std::shared_ptr<VectorType>)> distance_function,
+        DistanceFunction distance_function,
         size_t partition_height,
-        bool is_shift
+        bool is_shift,
+        size_t neighbourhood_len,
+        ldg::SummedAreaTable<VectorType> &summed_area_table,
+        std::vector<uint8_t> const &partitions
     )
     {
-        auto [num_rows, num_cols] = quad_tree.getBounds(0).second;
-        std::vector<std::vector<std::shared_ptr<VectorType>>> target_map(num_rows * num_cols);
+        if (partitions.empty()) {
+            target_table.reset(quad_tree, partition_height);
+        } else {
+            for (size_t partition = 0; partition < partitions.size(); ++partition) {
+                if (partitions[partition])
+                    target_table.clearTargets(partition);
+            }
+        }
 
         switch (target_type) {
             case HIGHEST_PARENT_HIERARCHY:
-                loadHighestParentHierarchyTargets(target_map, quad_tree, partition_height, is_shift);
+                loadHighestParentHierarchyTargets(target_table, quad_tree, partition_height, is_shift, partitions);
+                [[fallthrough]];
             case PARTITION_NEIGHBOURHOOD:
                 if (partition_height < quad_tree.getDepth() - 2) {
-                    loadPartitionNeighbourhoodTargets(target_map, quad_tree, distance_function, partition_height, is_shift);
+                    loadPartitionNeighbourhoodTargets(target_table, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len, summed_area_table, partitions);
                 }
                 break;
         }
-
-        return target_map;
     }
 }
 
@@ -1,14 +1,205 @@
 #include <vector>
 #include <memory>
+#include <functional>
 #include "app/include/ldg/util/math.hpp"
 #include "app/include/ldg/model/quad_assignment_tree.hpp"
 #include "app/include/self_sorting_map/method.hpp"
 #include "app/include/adapter/data.hpp"
+#include "app/include/adapter/reduction.hpp"
 #include "app/include/ldg/util/metric/distance_function_types.hpp"
 #include "app/include/program/run.hpp"
 #include "app/include/program/input/input_args.hpp"
 #include "app/include/program/input/input.hpp"
 
+/**
+ * Create an export of a tree of the full-resolution data in the current assignment of the sorted tree, with parents computed from
+ * the full-resolution data, which replaces the export of the sorted tree.
+ *
+ * @tparam VectorType
+ * @tparam FullVectorType
+ * @tparam DistanceFunction
+ * @param quad_tree The sorted tree.
+ * @param full_quad_tree
+ * @return
+ */
+template<typename VectorType, typename FullVectorType, typename DistanceFunction>
+std::function<void(program::ExportSettings &)> createFullResolutionExport(
+    ldg::QuadAssignmentTree<VectorType> &quad_tree,
+    ldg::QuadAssignmentTree<FullVectorType> &full_quad_tree
+) {
+    return [&quad_tree, &full_quad_tree](program::ExportSettings &settings) {
+        DistanceFunction full_distance_function;
+        full_quad_tree.getAssignment() = quad_tree.getAssignment();
+        full_quad_tree.markAllDirty();
+        ldg::computeParents(full_quad_tree, full_distance_function);
+        program::exportQuadTreeFiles(full_quad_tree, full_distance_function, settings);
+    };
+}
+
+/**
+ * Load the full-resolution data, reduce it to sorting features and delegate to the runner, using VectorType for the features.
+ * Exports keep referencing the full-resolution data, which is kept in a separate tree that follows the assignment of the sorted tree.
+ * If requested, the reduced features are normalized.
+ *
+ * @tparam VectorType
+ * @tparam DistanceFunction
+ * @param parse_result
+ */
+template<typename VectorType, typename DistanceFunction>
+void loadAndRunReduced(cxxopts::ParseResult const &parse_result)
+{
+    // The full-resolution data is only used for exports, so it is always dynamically sized.
+    using FullVectorType = Eigen::Matrix<typename VectorType::Scalar, Eigen::Dynamic, 1>;
+    auto [full_data, assignment, dims, depth, num_elements, data_dims] = program::loadDataFromInput<FullVectorType>(parse_result);
+    size_t reduced_len = std::min(full_data.getElementLen(), parse_result["reduced_dims"].as<size_t>());
+    auto reduction_type = static_cast<adapter::ReductionType>(parse_result["reduction"].as<size_t>());
+    auto data = adapter::reduceData<VectorType>(full_data, num_elements, reduced_len, reduction_type, parse_result["seed"].as<size_t>());
+    if (program::loadNormalizeFromInput(parse_result))
+        adapter::normalizeData(data, num_elements);
+
+    auto parent_type = static_cast<ldg::ParentType>(parse_result["parent_type"].as<size_t>());
+    auto layout = program::loadLayoutFromInput(parse_result, dims);
+    auto quad_tree = ldg::QuadAssignmentTree<VectorType>(std::move(data), assignment, dims.first, dims.second, depth, num_elements, { reduced_len, 1, 1 }, parent_type, layout);
+    auto full_quad_tree = ldg::QuadAssignmentTree<FullVectorType>(std::move(full_data), assignment, dims.first, dims.second, depth, num_elements, data_dims, parent_type, layout);
+    auto schedule = program::loadScheduleFromInput(parse_result);
+    auto sort_options = program::loadSortOptionsFromInput<DistanceFunction>(parse_result);
+    auto export_settings = program::loadExportSettingsFromInput(parse_result);
+    program::RANDOMIZER = std::mt19937(parse_result["seed"].as<size_t>());
+
+    // Exports use the current assignment of the reduced tree with parents computed from the full-resolution data
+    export_settings.full_resolution_export = createFullResolutionExport<VectorType, FullVectorType, DistanceFunction>(quad_tree, full_quad_tree);
+
+    program::run(quad_tree, schedule, sort_options, export_settings);
+}
+
+/**
+ * Load the data and sort on a normalized copy of it, while exports keep using the original data in the same way as for reduced
+ * features.
+ *
+ * @tparam VectorType
+ * @tparam DistanceFunction
+ * @param parse_result
+ */
+template<typename VectorType, typename DistanceFunction>
+void loadAndRunNormalized(cxxopts::ParseResult const &parse_result)
+{
+    auto [full_data, assignment, dims, depth, num_elements, data_dims] = program::loadDataFromInput<VectorType>(parse_result);
+    auto data = full_data;
+    adapter::normalizeData(data, num_elements);
+
+    auto parent_type = static_cast<ldg::ParentType>(parse_result["parent_type"].as<size_t>());
+    auto layout = program::loadLayoutFromInput(parse_result, dims);
+    auto quad_tree = ldg::QuadAssignmentTree<VectorType>(std::move(data), assignment, dims.first, dims.second, depth, num_elements, data_dims, parent_type, layout);
+    auto full_quad_tree = ldg::QuadAssignmentTree<VectorType>(std::move(full_data), assignment, dims.first, dims.second, depth, num_elements, data_dims, parent_type, layout);
+    auto schedule = program::loadScheduleFromInput(parse_result);
+    auto sort_options = program::loadSortOptionsFromInput<DistanceFunction>(parse_result);
+    auto export_settings = program::loadExportSettingsFromInput(parse_result);
+    program::RANDOMIZER = std::mt19937(parse_result["seed"].as<size_t>());
+
+    export_settings.full_resolution_export = createFullResolutionExport<VectorType, VectorType, DistanceFunction>(quad_tree, full_quad_tree);
+
+    program::run(quad_tree, schedule, sort_options, export_settings);
+}
+
+/**
+ * Load the quad tree and all settings from the input and delegate to the runner, using VectorType for storage and computations.
+ * If a reduction or normalization is requested, the sorting runs on reduced or normalized features instead.
+ *
+ * @tparam VectorType
+ * @tparam DistanceFunction
+ * @param parse_result
+ */
+template<typename VectorType, typename DistanceFunction>
+void loadAndRun(cxxopts::ParseResult const &parse_result)
+{
+    if constexpr (std::is_floating_point_v<typename VectorType::Scalar>) {
+        if (parse_result["reduction"].as<size_t>() != adapter::ReductionType::NONE)
+            return loadAndRunReduced<VectorType, DistanceFunction>(parse_result);
+        if (program::loadNormalizeFromInput(parse_result))
+            return loadAndRunNormalized<VectorType, DistanceFunction>(parse_result);
+    } else if (program::loadNormalizeFromInput(parse_result)) {
+        std::cerr << "Warning: Only floating point data can be normalized, using the data as is.\n";
+    }
+
+    auto [data, assignment, dims, depth, num_elements, data_dims] = program::loadDataFromInput<VectorType>(parse_result);
+    auto quad_tree = ldg::QuadAssignmentTree<VectorType>(
+        std::move(data),
+        assignment,
+        dims.first,
+        dims.second,
+        depth,
+        num_elements,
+        data_dims,
+        static_cast<ldg::ParentType>(parse_result["parent_type"].as<size_t>()),
+        program::loadLayoutFromInput(parse_result, dims)
+    );
+    auto schedule = program::loadScheduleFromInput(parse_result);
+    auto sort_options = program::loadSortOptionsFromInput<DistanceFunction>(parse_result);
+    auto export_settings = program::loadExportSettingsFromInput(parse_result);
+    program::RANDOMIZER = std::mt19937(parse_result["seed"].as<size_t>());
+
+    program::run(quad_tree, schedule, sort_options, export_settings);
+}
+
+/**
+ * Dispatch to a fixed-size vector type if the element length is one of the commonly used lengths, which allows the compiler
+ * to fully unroll and vectorize the distance and aggregation loops. Other lengths fall back to dynamically sized vectors.
+ *
+ * @tparam Scalar
+ * @tparam DistanceFunction
+ * @param element_len
+ * @param parse_result
+ */
+template<typename Scalar, typename DistanceFunction>
+void loadAndRunWithElementLen(size_t element_len, cxxopts::ParseResult const &parse_result)
+{
+    switch (element_len) {
+        case 3:     // RGB
+            loadAndRun<Eigen::Matrix<Scalar, 3, 1>, DistanceFunction>(parse_result);
+            break;
+        case 16:
+            loadAndRun<Eigen::Matrix<Scalar, 16, 1>, DistanceFunction>(parse_result);
+            break;
+        case 32:
+            loadAndRun<Eigen::Matrix<Scalar, 32, 1>, DistanceFunction>(parse_result);
+            break;
+        case 64:
+            loadAndRun<Eigen::Matrix<Scalar, 64, 1>, DistanceFunction>(parse_result);
+            break;
+        default:
+            loadAndRun<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>, DistanceFunction>(parse_result);
+    }
+}
+
+/**
+ * Dispatch to the storage type of the data.
+ *
+ * @tparam DistanceFunction
+ * @param data_type
+ * @param element_len
+ * @param parse_result
+ */
+template<typename DistanceFunction>
+void loadAndRunWithDataType(program::DataType data_type, size_t element_len, cxxopts::ParseResult const &parse_result)
+{
+    switch (data_type) {
+        case program::DataType::FLOAT64:
+            loadAndRunWithElementLen<double, DistanceFunction>(element_len, parse_result);
+            break;
+        case program::DataType::FLOAT32:
+            loadAndRunWithElementLen<float, DistanceFunction>(element_len, parse_result);
+            break;
+        case program::DataType::UINT8:     // Integer data is typically image data, so we only use dynamic sizes.
+            loadAndRun<Eigen::Matrix<uint8_t, Eigen::Dynamic, 1>, DistanceFunction>(parse_result);
+            break;
+        case program::DataType::UINT16:
+            loadAndRun<Eigen::Matrix<uint16_t, Eigen::Dynamic, 1>, DistanceFunction>(parse_result);
+            break;
+        default:
+            throw std::invalid_argument("Unsupported data type");
+    }
+}
+
 /**
  * Entrypoint of the application. Handles input and then delegates to the runner.
  *
@@ -24,14 +215,19 @@ int main(int argc, const char **argv)
         if (parse_result.count("cores"))
             omp_set_num_threads(parse_result["cores"].as<size_t>());
 
-        auto [data, assignment, dims, depth, num_elements, data_dims] = program::loadDataFromInput<Eigen::VectorXd>(parse_result);
-        auto quad_tree = ldg::QuadAssignmentTree<Eigen::VectorXd>(data, assignment, dims.first, dims.second, depth, num_elements, data_dims, static_cast<ldg::ParentType>(parse_result["parent_type"].as<size_t>()));
-        auto schedule = program::loadScheduleFromInput(parse_result);
-        auto sort_options = program::loadSortOptionsFromInput<Eigen::VectorXd>(parse_result);
-        auto export_settings = program::loadExportSettingsFromInput(parse_result);
-        program::RANDOMIZER = std::mt19937(parse_result["seed"].as<size_t>());
-
-        program::run(quad_tree, schedule, sort_options, export_settings);
+        size_t element_len = program::loadDataElementLenFromInput(parse_result);
+        program::DataType data_type = program::loadDataTypeFromInput(parse_result);
+        if (parse_result["reduction"].as<size_t>() != adapter::ReductionType::NONE) {
+            // Reduced features are real-valued, so integer data is reduced into floats.
+            element_len = std::min(element_len, parse_result["reduced_dims"].as<size_t>());
+            if (data_type == program::DataType::UINT8 || data_type == program::DataType::UINT16)
+                data_type = program::DataType::FLOAT32;
+        }
+        // The distance function is a template parameter of the whole sorting, so it is selected once here.
+        auto distance_function_type = static_cast<ldg::DistanceFunctionType>(parse_result["distance_function"].as<size_t>());
+        ldg::withDistanceFunction(distance_function_type, [&](auto distance_function) {
+            loadAndRunWithDataType<decltype(distance_function)>(data_type, element_len, parse_result);
+        });
     } catch (const std::exception &exception) {
         std::cerr << "ldg_ssm: " << exception.what() << std::endl;
         std::cerr << "Something went wrong during excecution. Exiting..." << std::endl;
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <Eigen/Core>
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/ldg/util/math.hpp"
+#include "app/include/ldg/util/tree_functions.hpp"
+#include "app/include/ldg/util/metric/normalized_euclidean_distance.hpp"
+#include "app/include/self_sorting_map/permutations.hpp"
+#include "app/include/self_sorting_map/target_distances.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
+
+/**
+ * Regression tests for minimum child parents. Their ties are broken by the order of the children, and the batched target distances
+ * should give the same exact distances as the pairwise distance function for targets that are copies of elements.
+ */
+
+using VectorType = Eigen::VectorXd;
+
+static size_t num_failures = 0;
+
+/**
+ * Report a failed check.
+ *
+ * @param condition
+ * @param message
+ */
+static void check(bool condition, char const *message)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+        ++num_failures;
+    }
+}
+
+/**
+ * Create a min-child quad tree where the data rows are assigned to the leaves in row-major order.
+ *
+ * @param num_rows
+ * @param num_cols
+ * @param values
+ * @return
+ */
+static ldg::QuadAssignmentTree<VectorType> createQuadTree(size_t num_rows, size_t num_cols, std::vector<VectorType> const &values)
+{
+    size_t depth = static_cast<size_t>(std::ceil(std::log2(std::max(num_rows, num_cols)))) + 1;
+    ldg::FeatureMatrix<VectorType> data(ldg::determineRequiredArrayCapacity(num_rows, num_cols), values[0].size());
+    for (size_t idx = 0; idx < values.size(); ++idx)
+        data.setRow(idx, values[idx]);
+
+    return ldg::QuadAssignmentTree<VectorType>(
+        std::move(data),
+        ldg::createAssignment(num_rows * num_cols),
+        num_rows,
+        num_cols,
+        depth,
+        values.size(),
+        { static_cast<size_t>(values[0].size()), 1, 1 },
+        ldg::ParentType::MINIMUM_CHILD
+    );
+}
+
+/**
+ * Children with equal summed distances resolve to the first of them, in [NW, NE, SW, SE] order. Void children are skipped.
+ */
+static void testMinimumIndexTies()
+{
+    VectorType a{{ 0., 0. }}, b{{ 1., 0. }};
+    ldg::NormalizedEuclideanDistance distance_function;
+
+    std::array<ldg::VectorView<VectorType>, 4> children{ ldg::VectorView(&b), ldg::VectorView(&a), ldg::VectorView(&b), ldg::VectorView(&a) };
+    check(ldg::findMinimumIndex(children, distance_function) == 0, "ties should resolve to the first child");
+
+    children = { nullptr, ldg::VectorView(&a), ldg::VectorView(&b), ldg::VectorView(&a) };
+    check(ldg::findMinimumIndex(children, distance_function) == 1, "ties should resolve to the first non-void child");
+}
+
+/**
+ * The parent of tied children is the value of the first child, which changes along with the first child.
+ */
+static void testParentTies()
+{
+    VectorType a{{ 0., 0. }}, b{{ 1., 0. }};
+    auto quad_tree = createQuadTree(2, 2, { b, a, b, a });
+    ldg::NormalizedEuclideanDistance distance_function;
+
+    ldg::computeParents(quad_tree, distance_function);
+    check(*quad_tree.getValue({ 1, 0 }) == b, "the parent should be the first child");
+
+    quad_tree.setAssignmentValue({ 0, 0 }, 1);
+    quad_tree.setAssignmentValue({ 0, 1 }, 0);
+    ldg::computeParents(quad_tree, distance_function);
+    check(*quad_tree.getValue({ 1, 0 }) == a, "the parent should follow the first child after an exchange");
+}
+
+/**
+ * Exchanges that tie with keeping all nodes in place are not applied, since the first permutation (the identity) wins ties.
+ * Ties between other permutations resolve to the first of them in lexicographic order.
+ */
+static void testPermutationTies()
+{
+    for (size_t num_nodes = 2; num_nodes <= 4; ++num_nodes) {
+        ssm::CostMatrix costs{};
+        auto permutation = ssm::findBestPermutation(costs, num_nodes);
+        for (size_t idx = 0; idx < num_nodes; ++idx)
+            check(permutation[idx] == idx, "tied permutations should keep the nodes in place");
+    }
+
+    ssm::CostMatrix costs{};
+    for (size_t idx = 0; idx < 4; ++idx)
+        costs[idx][idx] = 1.;
+    auto permutation = ssm::findBestPermutation(costs, 4);
+    check(permutation[0] == 1 && permutation[1] == 0 && permutation[2] == 3 && permutation[3] == 2, "tied exchanges should resolve to the first permutation");
+}
+
+/**
+ * The batched distance of an element to a copy of itself is exactly 0, such that exchanges tie in the same way as for the
+ * pairwise distances.
+ */
+static void testTargetDistancesOfCopies()
+{
+    std::vector<VectorType> values;
+    for (size_t idx = 0; idx < 16; ++idx)
+        values.push_back(VectorType{{ 0.1 * static_cast<double>(idx) + 0.7, 1. / (1. + static_cast<double>(idx)), 0.3 }});
+    auto quad_tree = createQuadTree(4, 4, values);
+    ldg::NormalizedEuclideanDistance distance_function;
+
+    // The target of every 2x2 partition is its top left leaf
+    ssm::TargetTable<VectorType> target_table;
+    target_table.reset(quad_tree, 1);
+    std::array<size_t, 4> target_leaves{ 0, 2, 8, 10 };
+    for (size_t partition = 0; partition < 4; ++partition)
+        target_table.addTarget(partition, quad_tree.getValue({ 0, target_leaves[partition] }));
+
+    // A single block of 2x2 partitions, of which every exchange pairs up the same cell of all partitions
+    std::vector<std::vector<long>> cell_pairings_array(4, { 0, 1, 2, 3 });
+    ssm::TargetDistances target_distances;
+    ssm::computeTargetDistances(target_distances, quad_tree, distance_function, target_table, cell_pairings_array, { 0 }, 2, 2, { 0, 0 }, 1, 0, 4);
+    for (long exchange = 0; exchange < 4; ++exchange) {
+        for (int slot = 0; slot < 4; ++slot) {
+            size_t leaf = ldg::rowMajorIndex(slot / 2 * 2 + exchange / 2, slot % 2 * 2 + exchange % 2, 4);
+            for (int target_slot = 0; target_slot < 4; ++target_slot) {
+                size_t target_leaf = target_leaves[target_slot];
+                double expected = distance_function(quad_tree.getValue({ 0, leaf }), quad_tree.getValue({ 0, target_leaf }));
+                double actual = target_distances(exchange, slot, target_slot);
+                if (leaf == target_leaf)
+                    check(actual == 0., "the distance to a copy should be exactly 0");
+                else
+                    check(std::abs(actual - expected) <= 1e-12, "the batched distance should match the pairwise distance");
+            }
+        }
+    }
+}
+
+int main()
+{
+    testMinimumIndexTies();
+    testParentTies();
+    testPermutationTies();
+    testTargetDistancesOfCopies();
+
+    if (num_failures > 0) {
+        std::cerr << num_failures << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "app/include/self_sorting_map/permutations.hpp"
+
+/**
+ * Regression tests for the linear assignment solver. Its total cost should match the cost of the best permutation found by
+ * enumerating all permutations. The permutations themselves may differ if several of them tie.
+ */
+
+static size_t num_failures = 0;
+
+/**
+ * Report a failed check.
+ *
+ * @param condition
+ * @param message
+ */
+static void check(bool condition, char const *message)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+        ++num_failures;
+    }
+}
+
+/**
+ * @param costs
+ * @param permutation
+ * @param num_nodes
+ * @return The total cost of placing node permutation[idx] at position idx.
+ */
+static double computeTotalCost(ssm::CostMatrix const &costs, ssm::Permutation const &permutation, size_t num_nodes)
+{
+    double total = 0.;
+    for (size_t idx = 0; idx < num_nodes; ++idx)
+        total += costs[permutation[idx]][idx];
+    return total;
+}
+
+/**
+ * @param permutation
+ * @param num_nodes
+ * @return Whether every node is placed exactly once and the unused entries keep their nodes in place.
+ */
+static bool isPermutation(ssm::Permutation const &permutation, size_t num_nodes)
+{
+    std::array<bool, ssm::MAX_EXCHANGE_NODES> is_placed{};
+    for (size_t idx = 0; idx < num_nodes; ++idx) {
+        if (permutation[idx] >= num_nodes || is_placed[permutation[idx]])
+            return false;
+        is_placed[permutation[idx]] = true;
+    }
+    for (size_t idx = num_nodes; idx < ssm::MAX_EXCHANGE_NODES; ++idx) {
+        if (permutation[idx] != idx)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Compare the solver against enumerating all permutations on random cost matrices. Integer costs are included to cause ties.
+ *
+ * @tparam NumNodes
+ * @param generator
+ * @param num_trials
+ */
+template<size_t NumNodes>
+static void testAgainstEnumeration(std::mt19937 &generator, size_t num_trials)
+{
+    std::uniform_real_distribution<double> real_distribution(0., 1.);
+    std::uniform_int_distribution<int> int_distribution(0, 3);
+    for (size_t trial = 0; trial < num_trials; ++trial) {
+        bool is_integer = trial % 2 == 1;
+        ssm::CostMatrix costs{};
+        for (size_t node = 0; node < NumNodes; ++node) {
+            for (size_t position = 0; position < NumNodes; ++position)
+                costs[node][position] = is_integer ? int_distribution(generator) : real_distribution(generator);
+        }
+
+        auto expected = ssm::findBestPermutation<NumNodes>(costs);
+        auto actual = ssm::solveAssignment(costs, NumNodes);
+        check(isPermutation(actual, NumNodes), "the solver should return a permutation");
+        check(std::abs(computeTotalCost(costs, actual, NumNodes) - computeTotalCost(costs, expected, NumNodes)) <= 1e-12,
+              "the solver should find the lowest total cost");
+    }
+}
+
+int main()
+{
+    std::mt19937 generator(1);
+    testAgainstEnumeration<4>(generator, 1000);
+    testAgainstEnumeration<5>(generator, 1000);
+
+    if (num_failures > 0) {
+        std::cerr << num_failures << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
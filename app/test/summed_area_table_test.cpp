@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <Eigen/Core>
+#include "app/include/ldg/model/quad_assignment_tree.hpp"
+#include "app/include/ldg/util/summed_area_table.hpp"
+#include "app/include/ldg/util/tree_functions.hpp"
+#include "app/include/ldg/util/metric/normalized_euclidean_distance.hpp"
+#include "app/include/self_sorting_map/target_cache.hpp"
+#include "app/include/self_sorting_map/targets.hpp"
+#include "app/include/self_sorting_map/target/target_table.hpp"
+#include "app/include/self_sorting_map/target/target_type.hpp"
+
+/**
+ * Regression tests for the incremental updates of the summed-area table and the target cache. After only some parents are
+ * recomputed, both should give the same results as when they are built from scratch.
+ */
+
+using VectorType = Eigen::VectorXd;
+
+static size_t num_failures = 0;
+
+/**
+ * Report a failed check.
+ *
+ * @param condition
+ * @param message
+ */
+static void check(bool condition, char const *message)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+        ++num_failures;
+    }
+}
+
+/**
+ * Create an averaged quad tree of random data, where the last cells of the grid are void.
+ *
+ * @param num_rows
+ * @param num_cols
+ * @param num_void
+ * @param generator
+ * @return
+ */
+static ldg::QuadAssignmentTree<VectorType> createQuadTree(size_t num_rows, size_t num_cols, size_t num_void, std::mt19937 &generator)
+{
+    std::uniform_real_distribution<double> distribution(0., 1.);
+    size_t depth = static_cast<size_t>(std::ceil(std::log2(std::max(num_rows, num_cols)))) + 1;
+    size_t num_values = num_rows * num_cols - num_void;
+    ldg::FeatureMatrix<VectorType> data(ldg::determineRequiredArrayCapacity(num_rows, num_cols), 3);
+    for (size_t idx = 0; idx < num_values; ++idx)
+        data.setRow(idx, VectorType{{ distribution(generator), distribution(generator), distribution(generator) }});
+
+    return ldg::QuadAssignmentTree<VectorType>(
+        std::move(data),
+        ldg::createAssignment(num_rows * num_cols),
+        num_rows,
+        num_cols,
+        depth,
+        num_values,
+        { 3, 1, 1 },
+        ldg::ParentType::NORMALIZED_AVERAGE
+    );
+}
+
+/**
+ * Swap a few random leaves and recompute the parents, which only recomputes the parents above the swapped leaves.
+ *
+ * @param quad_tree
+ * @param generator
+ * @param num_swaps
+ */
+static void swapLeaves(ldg::QuadAssignmentTree<VectorType> &quad_tree, std::mt19937 &generator, size_t num_swaps)
+{
+    size_t num_leaves = quad_tree.getAssignment().size();
+    for (size_t swap = 0; swap < num_swaps; ++swap) {
+        size_t a = generator() % num_leaves;
+        size_t b = generator() % num_leaves;
+        size_t value_a = quad_tree.getAssignment()[a];
+        size_t value_b = quad_tree.getAssignment()[b];
+        quad_tree.setAssignmentValue({ 0, a }, value_b);
+        quad_tree.setAssignmentValue({ 0, b }, value_a);
+    }
+    ldg::computeParents(quad_tree, ldg::NormalizedEuclideanDistance());
+}
+
+/**
+ * @param a
+ * @param b
+ * @return Whether both views are void or both have the same values up to rounding.
+ */
+static bool isClose(ldg::VectorView<VectorType> const &a, ldg::VectorView<VectorType> const &b)
+{
+    if (a == nullptr || b == nullptr)
+        return a == nullptr && b == nullptr;
+    return ((*a) - (*b)).norm() <= 1e-12;
+}
+
+/**
+ * The averages of an updated table should equal those of a fresh table for every rectangle, including void nodes.
+ */
+static void testUpdate()
+{
+    std::mt19937 generator(1);
+    auto quad_tree = createQuadTree(27, 23, 9, generator);
+    ldg::computeParents(quad_tree, ldg::NormalizedEuclideanDistance());
+
+    size_t height = 1;
+    ldg::SummedAreaTable<VectorType> summed_area_table;
+    summed_area_table.update(quad_tree, height);
+    for (size_t round = 0; round < 10; ++round) {
+        swapLeaves(quad_tree, generator, 3);
+        summed_area_table.update(quad_tree, height);
+
+        ldg::SummedAreaTable<VectorType> fresh_table;
+        fresh_table.update(quad_tree, height);
+        auto [num_rows, num_cols] = quad_tree.getBounds(height).second;
+        bool is_equal = true;
+        for (size_t min_y = 0; min_y < num_rows; ++min_y) {
+            for (size_t max_y = min_y + 1; max_y <= num_rows; ++max_y) {
+                for (size_t min_x = 0; min_x < num_cols; ++min_x) {
+                    for (size_t max_x = min_x + 1; max_x <= num_cols; ++max_x)
+                        is_equal &= summed_area_table.getAverage(min_y, max_y, min_x, max_x) == fresh_table.getAverage(min_y, max_y, min_x, max_x);
+                }
+            }
+        }
+        check(is_equal, "the averages of an updated table should match a fresh table");
+    }
+}
+
+/**
+ * The targets of the cache after a partial reload should equal the targets loaded from scratch, for both configurations and
+ * for neighbourhoods that are summed directly as well as looked up in the summed-area table. The kept targets of unchanged
+ * partitions may differ in the last bits from targets that are looked up in a table that includes the changed nodes.
+ */
+static void testTargetCacheLoad()
+{
+    std::mt19937 generator(2);
+    auto quad_tree = createQuadTree(27, 23, 9, generator);
+    ldg::NormalizedEuclideanDistance distance_function;
+    ldg::computeParents(quad_tree, distance_function);
+
+    size_t partition_height = 1;
+    for (auto target_type : { ssm::PARTITION_NEIGHBOURHOOD, ssm::HIGHEST_PARENT_HIERARCHY }) {
+        for (size_t neighbourhood_len : { 2, 4 }) {
+            ssm::TargetCache<VectorType> target_cache;
+            for (bool is_shift : { false, true })
+                target_cache.load(target_type, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len);
+
+            for (size_t round = 0; round < 5; ++round) {
+                swapLeaves(quad_tree, generator, 2);
+                for (bool is_shift : { false, true }) {
+                    target_cache.load(target_type, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len);
+
+                    ssm::TargetTable<VectorType> fresh_table;
+                    ldg::SummedAreaTable<VectorType> summed_area_table;
+                    ssm::loadTargetTable(fresh_table, target_type, quad_tree, distance_function, partition_height, is_shift, neighbourhood_len, summed_area_table, {});
+
+                    auto const &target_table = target_cache.getTargetTable(is_shift);
+                    auto [num_rows, num_cols] = quad_tree.getBounds(partition_height).second;
+                    bool is_equal = true;
+                    for (size_t partition = 0; partition < num_rows * num_cols; ++partition) {
+                        is_equal &= target_table.getNumTargets(partition) == fresh_table.getNumTargets(partition);
+                        for (size_t idx = 0; idx < std::min(target_table.getNumTargets(partition), fresh_table.getNumTargets(partition)); ++idx)
+                            is_equal &= isClose(target_table.getTarget(partition, idx), fresh_table.getTarget(partition, idx));
+                    }
+                    check(is_equal, "the targets after a partial reload should match the targets loaded from scratch");
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    testUpdate();
+    testTargetCacheLoad();
+
+    if (num_failures > 0) {
+        std::cerr << num_failures << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}